@@ -15,6 +15,7 @@ class BBox
   Vec3 pmin{INIT_NONE}, pmax{INIT_NONE};
 
   BBox() { reset(); }
+  explicit BBox(NoInit_t) { }
   BBox(const Vec3& pt) : pmin{pt}, pmax{pt} { }
   BBox(const BBox& b1, const BBox& b2);
   BBox(const Vec3* pt_list, int pt_count);
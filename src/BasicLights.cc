@@ -7,6 +7,10 @@
 #include "Shader.hh"
 #include "Scene.hh"
 #include "RegisterLight.hh"
+#include "JobState.hh"
+#include "BBox.hh"
+#include <algorithm>
+#include <cmath>
 
 
 // **** Sun Class ****
@@ -32,7 +36,7 @@ bool Sun::luminate(JobState& js, const Scene& s, const Ray& r,
       .min_length = s.ray_moveout
     };
 
-    if (s.castShadowRay(js, sray)) { return false; }
+    if (s.lightBlocked(js, sray, _index, &_shadowGrid)) { return false; }
   }
 
   result.dir = unit_dir;
@@ -43,6 +47,20 @@ bool Sun::luminate(JobState& js, const Scene& s, const Ray& r,
 }
 
 
+void Sun::initShadows(const Scene& s)
+{
+  // all shadow rays have the same direction so objects can be binned by
+  // their projection on the plane perpendicular to the light
+  _shadowGrid.clear();
+  if (s.shadow) { _shadowGrid.build(s.shadowObjects(), -_finalDir); }
+}
+
+Flt Sun::sampleWeight(const Vec3& pt, const Vec3& normal) const
+{
+  return _power * std::max(dotProduct(normal, -_finalDir), 0.0);
+}
+
+
 // **** PointLight Class ****
 REGISTER_LIGHT_CLASS(PointLight,"light");
 
@@ -59,28 +77,103 @@ bool PointLight::luminate(JobState& js, const Scene& s, const Ray& r,
 {
   const Vec3 dir = _finalPos - eh.global_pt;
   const Flt len = dir.length();
+  const Flt atten = attenuation(len);
+  if (!isPositive(atten)) { return false; }
+
   const Vec3 unit_dir = dir * (1.0 / len);
   const Flt angle = dotProduct(eh.normal, unit_dir);
   if (!isPositive(angle)) { return false; }
 
+  Flt lit = atten;
   if (s.shadow) {
-    Ray sray {
-      .base       = eh.global_pt,
-      .dir        = unit_dir,
-      .min_length = s.ray_moveout,
-      .max_length = len
-    };
+    if (_samples > 1) {
+      lit *= litFraction(js, s, eh.global_pt, unit_dir);
+      if (!isPositive(lit)) { return false; }
+    } else {
+      Ray sray {
+        .base       = eh.global_pt,
+        .dir        = unit_dir,
+        .min_length = s.ray_moveout,
+        .max_length = len
+      };
 
-    if (s.castShadowRay(js, sray)) { return false; }
+      if (s.lightBlocked(js, sray, _index)) { return false; }
+    }
   }
 
   result.dir = unit_dir;
   result.distance = len;
   result.angle = angle;
-  result.energy = _energy->evaluate(js, s, r, eh);
+  result.energy = _energy->evaluate(js, s, r, eh) * lit;
+  return true;
+}
+
+Flt PointLight::sampleWeight(const Vec3& pt, const Vec3& normal) const
+{
+  // power * cos / distance^2
+  const Vec3 dir = _finalPos - pt;
+  const Flt len2 = dir.lengthSqr();
+  const Flt len = std::sqrt(len2);
+  const Flt c = dotProduct(normal, dir) / len;
+  if (!isPositive(c)) { return 0.0; }
+
+  return (_power * c * attenuation(len)) / std::max(len2, VERY_SMALL);
+}
+
+bool PointLight::bound(BBox& box) const
+{
+  if (!isPositive(range)) { return false; }
+
+  const Vec3 r{range, range, range};
+  box = BBox{_finalPos - r};
+  box.fit(_finalPos + r);
   return true;
 }
 
+Flt PointLight::litFraction(
+  JobState& js, const Scene& s, const Vec3& pt, const Vec3& unit_dir) const
+{
+  // light is sampled as a disk of _radius facing the shading point
+  Vec3 t1{INIT_NONE}, t2{INIT_NONE};
+  orthonormalBasis(unit_dir, t1, t2);
+
+  const auto isLit = [&](const Vec2& d) {
+    const Vec3 dir =
+      _finalPos + (t1 * (d.x * _radius)) + (t2 * (d.y * _radius)) - pt;
+    const Flt len = dir.length();
+    Ray sray {
+      .base       = pt,
+      .dir        = dir * (1.0 / len),
+      .min_length = s.ray_moveout,
+      .max_length = len
+    };
+    return !s.castShadowRay(js, sray, _index);
+  };
+
+  // adaptive shortcut - if a few samples around the rim all agree, the
+  // point is assumed to be fully lit or fully shadowed
+  constexpr int RIM_SAMPLES = 4;
+  if (_samples > RIM_SAMPLES) {
+    const Flt a0 = js.rnd.uniform() * (2.0 * PI / RIM_SAMPLES);
+    int rimLit = 0;
+    for (int i = 0; i < RIM_SAMPLES; ++i) {
+      const Flt a = a0 + (Flt(i) * (2.0 * PI / RIM_SAMPLES));
+      if (isLit({std::cos(a), std::sin(a)})) { ++rimLit; }
+    }
+
+    if (rimLit == 0) { return 0.0; }
+    else if (rimLit == RIM_SAMPLES) { return 1.0; }
+  }
+
+  // stratified samples over whole disk
+  const int stream = js.newStream();
+  int lit = 0;
+  for (int i = 0; i < _samples; ++i) {
+    if (isLit(js.rndLightPt(i, _samples, stream))) { ++lit; }
+  }
+  return Flt(lit) / Flt(_samples);
+}
+
 
 // **** SpotLight Class ****
 REGISTER_LIGHT_CLASS(SpotLight,"spotlight");
@@ -88,13 +181,102 @@ REGISTER_LIGHT_CLASS(SpotLight,"spotlight");
 int SpotLight::init(Scene& s)
 {
   _finalPos = _trans.pointLocalToGlobal({0,0,0});
-  _finalDir = _trans.vectorLocalToGlobal(dir);
+  _finalDir = unitVec(_trans.vectorLocalToGlobal(dir));
+
+  const Flt o = std::clamp(outer, 0.0, 180.0);
+  const Flt i = std::clamp(inner, 0.0, o);
+  _cosOuter = std::cos(degToRad(o));
+  _cosInner = std::cos(degToRad(i));
   return 0;
 }
 
+Flt SpotLight::coneFactor(const Vec3& unit_dir) const
+{
+  // unit_dir points from shading point to light
+  const Flt c = -dotProduct(unit_dir, _finalDir);
+  if (c <= _cosOuter) { return 0.0; }
+  else if (c >= _cosInner) { return 1.0; }
+
+  const Flt t = (c - _cosOuter) / (_cosInner - _cosOuter);
+  return (falloff == 1.0) ? t : std::pow(t, falloff);
+}
+
 bool SpotLight::luminate(JobState& js, const Scene& s, const Ray& r,
                          const EvaluatedHit& eh, LightResult& result) const
 {
-  // FIXME: finish SpotLight::luminate()
-  return false;
+  const Vec3 dir = _finalPos - eh.global_pt;
+  const Flt len = dir.length();
+  const Flt atten = attenuation(len);
+  if (!isPositive(atten)) { return false; }
+
+  const Vec3 unit_dir = dir * (1.0 / len);
+  const Flt angle = dotProduct(eh.normal, unit_dir);
+  if (!isPositive(angle)) { return false; }
+
+  // cone test before shadow ray
+  const Flt cone = coneFactor(unit_dir);
+  if (!isPositive(cone)) { return false; }
+
+  if (s.shadow) {
+    Ray sray {
+      .base       = eh.global_pt,
+      .dir        = unit_dir,
+      .min_length = s.ray_moveout,
+      .max_length = len
+    };
+
+    if (s.lightBlocked(js, sray, _index)) { return false; }
+  }
+
+  result.dir = unit_dir;
+  result.distance = len;
+  result.angle = angle;
+  result.energy = _energy->evaluate(js, s, r, eh) * (atten * cone);
+  return true;
+}
+
+bool SpotLight::bound(BBox& box) const
+{
+  if (!isPositive(range)) { return false; }
+
+  const Vec3 rv{range, range, range};
+  if (_cosOuter <= 0.0) {
+    // cone wider than a hemisphere - use bounding box of range sphere
+    box = BBox{_finalPos - rv};
+    box.fit(_finalPos + rv);
+    return true;
+  }
+
+  // bound cone apex, base disk & spherical cap between disk and range
+  const Flt sinOuter = std::sqrt(1.0 - sqr(_cosOuter));
+  const Vec3 center = _finalPos + (_finalDir * (range * _cosOuter));
+  const Flt diskRadius = range * sinOuter;
+
+  box = BBox{_finalPos};
+  for (Vec3::size_type a = 0; a < 3; ++a) {
+    const Flt ext =
+      diskRadius * std::sqrt(std::max(1.0 - sqr(_finalDir[a]), 0.0));
+    Flt lo = center[a] - ext, hi = center[a] + ext;
+
+    // cap reaches range along axis if axis is inside cone
+    if (-_finalDir[a] > _cosOuter) { lo = _finalPos[a] - range; }
+    if (_finalDir[a] > _cosOuter) { hi = _finalPos[a] + range; }
+
+    box.pmin[a] = std::min(box.pmin[a], lo);
+    box.pmax[a] = std::max(box.pmax[a], hi);
+  }
+  return true;
+}
+
+Flt SpotLight::sampleWeight(const Vec3& pt, const Vec3& normal) const
+{
+  const Vec3 dir = _finalPos - pt;
+  const Flt len2 = dir.lengthSqr();
+  const Flt len = std::sqrt(len2);
+  const Vec3 unit_dir = dir * (1.0 / len);
+  const Flt c = dotProduct(normal, unit_dir);
+  if (!isPositive(c)) { return 0.0; }
+
+  return (_power * c * attenuation(len) * coneFactor(unit_dir))
+    / std::max(len2, VERY_SMALL);
 }
@@ -7,6 +7,7 @@
 
 #pragma once
 #include "Light.hh"
+#include "ShadowGrid.hh"
 
 
 // **** Types ****
@@ -20,9 +21,12 @@ class Sun final : public Light
   int init(Scene& s) override;
   bool luminate(JobState& js, const Scene& s, const Ray& r,
                 const EvaluatedHit& eh, LightResult& result) const override;
+  Flt sampleWeight(const Vec3& pt, const Vec3& normal) const override;
+  void initShadows(const Scene& s) override;
 
  private:
   Vec3 _finalDir;
+  ShadowGrid _shadowGrid;
 };
 
 class PointLight final : public Light
@@ -38,17 +42,26 @@ class PointLight final : public Light
   int init(Scene& s) override;
   bool luminate(JobState& js, const Scene& s, const Ray& r,
                 const EvaluatedHit& eh, LightResult& result) const override;
+  bool bound(BBox& box) const override;
+  Flt sampleWeight(const Vec3& pt, const Vec3& normal) const override;
 
  private:
   Transform _trans;
   Vec3 _finalPos;
   Flt _radius = 0;
   int _samples = 1;
+
+  [[nodiscard]] Flt litFraction(
+    JobState& js, const Scene& s, const Vec3& pt, const Vec3& unit_dir) const;
 };
 
 class SpotLight final : public Light
 {
  public:
+  Flt inner = 20;   // full intensity cone half-angle (degrees)
+  Flt outer = 30;   // cone half-angle where intensity reaches zero
+  Flt falloff = 1;  // exponent of intensity falloff between cones
+
   // SceneItem Functions
   std::string desc() const override { return "<SpotLight>"; }
   Transform* trans() override { return &_trans; }
@@ -57,8 +70,13 @@ class SpotLight final : public Light
   int init(Scene& s) override;
   bool luminate(JobState& js, const Scene& s, const Ray& r,
                 const EvaluatedHit& eh, LightResult& result) const override;
+  bool bound(BBox& box) const override;
+  Flt sampleWeight(const Vec3& pt, const Vec3& normal) const override;
 
  private:
   Transform _trans;
   Vec3 _finalPos, _finalDir;
+  Flt _cosInner = 1, _cosOuter = 1;
+
+  [[nodiscard]] Flt coneFactor(const Vec3& unit_dir) const;
 };
@@ -36,6 +36,11 @@ BBox Disc::bound(const Matrix* t) const
           t ? *t : _trans.final()};
 }
 
+BBox Disc::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  return clipBoundPoints(planeBoundPoints, axis, lo, hi);
+}
+
 Flt Disc::hitCost(const HitCostInfo& hc) const
 {
   return (_cost >= 0.0) ? _cost : hc.disc;
@@ -197,6 +202,11 @@ Vec3 Cone::normal(const Ray& r, const HitInfo& h) const
   return _trans.normalLocalToGlobal(n);
 }
 
+BBox Cone::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  return clipBoundPoints(CUBE_BOUND_POINTS, axis, lo, hi);
+}
+
 Flt Cone::hitCost(const HitCostInfo& hc) const
 {
   return (_cost >= 0.0) ? _cost : hc.cone;
@@ -218,6 +228,11 @@ int Cube::init(Scene& s, const Transform* tr)
   return 0;
 }
 
+BBox Cube::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  return clipBoundPoints(CUBE_BOUND_POINTS, axis, lo, hi);
+}
+
 Flt Cube::hitCost(const HitCostInfo& hc) const
 {
   return (_cost >= 0.0) ? _cost : hc.cube;
@@ -314,6 +329,11 @@ int Cylinder::init(Scene& s, const Transform* tr)
   return 0;
 }
 
+BBox Cylinder::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  return clipBoundPoints(CUBE_BOUND_POINTS, axis, lo, hi);
+}
+
 Flt Cylinder::hitCost(const HitCostInfo& hc) const
 {
   return (_cost >= 0.0) ? _cost : hc.cylinder;
@@ -521,6 +541,11 @@ Vec3 Paraboloid::normal(const Ray& r, const HitInfo& h) const
   return _trans.normalLocalToGlobal(n);
 }
 
+BBox Paraboloid::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  return clipBoundPoints(CUBE_BOUND_POINTS, axis, lo, hi);
+}
+
 Flt Paraboloid::hitCost(const HitCostInfo& hc) const
 {
   return (_cost >= 0.0) ? _cost : hc.paraboloid;
@@ -542,6 +567,11 @@ BBox Plane::bound(const Matrix* t) const
           t ? *t : _trans.final()};
 }
 
+BBox Plane::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  return clipBoundPoints(planeBoundPoints, axis, lo, hi);
+}
+
 Flt Plane::hitCost(const HitCostInfo& hc) const
 {
   return (_cost >= 0.0) ? _cost : hc.plane;
@@ -586,6 +616,11 @@ Vec3 Plane::normal(const Ray& r, const HitInfo& h) const
 // **** Sphere Class ****
 REGISTER_OBJECT_CLASS(Sphere,"sphere");
 
+BBox Sphere::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  return clipBoundPoints(CUBE_BOUND_POINTS, axis, lo, hi);
+}
+
 Flt Sphere::hitCost(const HitCostInfo& hc) const
 {
   return (_cost >= 0.0) ? _cost : hc.sphere;
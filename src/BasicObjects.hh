@@ -19,6 +19,7 @@ class Disc final : public Primitive
   // Object Functions
   int init(Scene& s, const Transform* tr) override;
   BBox bound(const Matrix* t) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
   int intersect(const Ray& r, HitList& hl) const override;
 
   // Primitive Functions
@@ -38,6 +39,7 @@ class Cone final : public Primitive
   // Object Functions
   int init(Scene& s, const Transform* tr) override;
   int intersect(const Ray& r, HitList& hl) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
 
   // Primitive Functions
   Flt hitCost(const HitCostInfo& hc) const override;
@@ -56,6 +58,7 @@ class Cube final : public Primitive
   // Object Functions
   int init(Scene& s, const Transform* tr) override;
   int intersect(const Ray& r, HitList& hl) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
 
   // Primitive Functions
   Flt hitCost(const HitCostInfo& hc) const override;
@@ -74,6 +77,7 @@ class Cylinder final : public Primitive
   // Object Functions
   int init(Scene& s, const Transform* tr) override;
   int intersect(const Ray& r, HitList& hl) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
 
   // Primitive Functions
   Flt hitCost(const HitCostInfo& hc) const override;
@@ -92,6 +96,7 @@ class Paraboloid final : public Primitive
   // Object Functions
   int init(Scene& s, const Transform* tr) override;
   int intersect(const Ray& r, HitList& hl) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
 
   // Primitive Functions
   Flt hitCost(const HitCostInfo& hc) const override;
@@ -110,6 +115,7 @@ class Plane final : public Primitive
   // Object Functions
   int init(Scene& s, const Transform* tr) override;
   BBox bound(const Matrix* t) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
   int intersect(const Ray& r, HitList& hl) const override;
 
   // Primitive Functions
@@ -128,6 +134,7 @@ class Sphere final : public Primitive
 
   // Object Functions
   int intersect(const Ray& r, HitList& hl) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
 
   // Primitive Functions
   Flt hitCost(const HitCostInfo& hc) const override;
@@ -4,6 +4,8 @@
 //
 
 #include "Bound.hh"
+#include "QuantizedBounds.hh"
+#include "Frustum.hh"
 #include "Intersect.hh"
 #include "Ray.hh"
 #include "Stats.hh"
@@ -14,6 +16,7 @@
 #include "ListUtil.hh"
 #include "StringUtil.hh"
 #include <vector>
+#include <algorithm>
 
 
 // **** Bound Class ****
@@ -24,7 +27,33 @@ std::string Bound::desc() const
 
 int Bound::intersect(const Ray& r, HitList& hl) const
 {
-  ++hl.stats().bound.tried;
+  if (!hitBox(r, hl.stats())) { return 0; }
+  if (qbounds) { return qbounds->intersect(qnode, qbox, r, hl); }
+
+  // Intersect all contained objects
+  int hits = 0;
+  for (auto& ob : objects) {
+    hits += ob->intersect(r, hl);
+  }
+
+  return hits;
+}
+
+bool Bound::occludes(const Ray& r, HitList& hl) const
+{
+  if (!hitBox(r, hl.stats())) { return false; }
+  if (qbounds) { return qbounds->occludes(qnode, qbox, r, hl); }
+
+  for (const Object* ob : occluders) {
+    if (ob->occludes(r, hl)) { return true; }
+  }
+
+  return false;
+}
+
+bool Bound::hitBox(const Ray& r, StatInfo& stats) const
+{
+  ++stats.bound.tried;
   Flt near_hit = -VERY_LARGE, far_hit = VERY_LARGE;
 
   for (unsigned int i = 0; i < 3; ++i) {
@@ -50,18 +79,43 @@ int Bound::intersect(const Ray& r, HitList& hl) const
 
   if (near_hit > far_hit
       || far_hit < r.min_length || near_hit >= r.max_length) {
-    return 0;  // miss
+    return false;  // miss
   }
 
-  ++hl.stats().bound.hit;
+  ++stats.bound.hit;
+  return true;
+}
 
-  // Intersect all contained objects
-  int hits = 0;
-  for (auto& ob : objects) {
-    hits += ob->intersect(r, hl);
-  }
 
-  return hits;
+// **** Spatial Split Types ****
+namespace {
+  constexpr int SPLIT_MIN_OVERLAP = 4;  // overlapped objects to split a box
+  constexpr Flt SPLIT_MIN_RATIO = 4.0;  // box vs average overlapped weight
+  constexpr int SPLIT_MAX_DEPTH = 6;    // splits of a single object box
+  constexpr Flt SPLIT_MAX_WEIGHT = .8;  // split pieces vs box weight
+
+  // reference to an object from one of the bounds it was split into
+  class SplitObject final : public Object
+  {
+   public:
+    SplitObject(const ObjectPtr& ob) : _object{ob} { }
+
+    // SceneItem Functions
+    std::string desc() const override {
+      return concat("<Split ", _object->desc(), '>'); }
+
+    // Object Functions
+    BBox bound(const Matrix* t) const override { return _object->bound(t); }
+    int intersect(const Ray& r, HitList& hl) const override {
+      return hl.firstTest(_object.get()) ? _object->intersect(r, hl) : 0; }
+    bool occludes(const Ray& r, HitList& hl) const override {
+      return hl.firstTest(_object.get()) && _object->occludes(r, hl); }
+    std::span<const ObjectPtr> children() const override {
+      return {&_object, 1}; }
+
+   private:
+    ObjectPtr _object;
+  };
 }
 
 
@@ -83,6 +137,7 @@ struct OptNode
   Flt objHitCost;   // cache Object::hitCost()
   Flt currentCost;  // cache OptNode::cost()
   OptNodeType type;
+  bool split = false;  // box only covers part of object
 
   // bound constructor
   OptNode(Flt cost) : objHitCost{cost}, type{NODE_BOUND} { }
@@ -124,6 +179,119 @@ static Flt treeCost(const OptNode* node_list, Flt bound_weight)
   return m_cost1 + m_cost2;
 }
 
+[[nodiscard]] static bool overlaps(const BBox& b1, const BBox& b2)
+{
+  BBox b = b1;
+  b.intersect(b2);
+  return !b.empty();
+}
+
+static void splitBox(const Object& ob, const BBox& box,
+                     std::span<const OptNode* const> others,
+                     int depth, int& budget, std::vector<BBox>& pieces)
+{
+  if (box.empty()) { return; }
+
+  std::vector<const OptNode*> overlap;
+  Flt overlapWeight = 0;
+  for (const OptNode* n : others) {
+    if (overlaps(box, n->box)) {
+      overlap.push_back(n);
+      overlapWeight += n->box.weight();
+    }
+  }
+
+  // only split boxes much larger than the objects they overlap
+  const int count = int(overlap.size());
+  if (depth >= SPLIT_MAX_DEPTH || budget <= 0 || count < SPLIT_MIN_OVERLAP
+      || (box.weight() * Flt(count)) < (SPLIT_MIN_RATIO * overlapWeight)) {
+    pieces.push_back(box);
+    return;
+  }
+
+  // split longest axis at median center of overlapped objects
+  const Vec3 len = box.pmax - box.pmin;
+  const unsigned int a = (len.x > len.y)
+    ? ((len.x > len.z) ? 0 : 2) : ((len.y > len.z) ? 1 : 2);
+  std::vector<Flt> centers;
+  centers.reserve(overlap.size());
+  for (const OptNode* n : overlap) { centers.push_back(n->box.center()[a]); }
+  const auto mid = centers.begin() + (count / 2);
+  std::nth_element(centers.begin(), mid, centers.end());
+
+  Flt pos = *mid;
+  if (!(pos > box.pmin[a] && pos < box.pmax[a])) {
+    pos = (box.pmin[a] + box.pmax[a]) * .5;
+  }
+
+  // (pieces are clipped to the object, not just its box, & must be
+  //  smaller than the box to be worth the extra reference)
+  BBox lo = ob.clippedBound(a, box.pmin[a], pos);
+  lo.intersect(box);
+  BBox hi = ob.clippedBound(a, pos, box.pmax[a]);
+  hi.intersect(box);
+  if ((lo.weight() + hi.weight()) > (SPLIT_MAX_WEIGHT * box.weight())) {
+    pieces.push_back(box);
+    return;
+  }
+
+  if (!lo.empty() && !hi.empty()) { --budget; }
+  splitBox(ob, lo, overlap, depth + 1, budget, pieces);
+  splitBox(ob, hi, overlap, depth + 1, budget, pieces);
+}
+
+static int splitLargeNodes(OptNode* node_list, int budget)
+{
+  // SBVH style spatial splits - large objects overlapping many others
+  // are referenced from several nodes with clipped boxes so they can be
+  // grouped with nearby objects
+  // (only for objects outside of unions so duplicate hits don't affect
+  //  csg results)
+  std::vector<const OptNode*> nodes;
+  for (OptNode* n = node_list; n != nullptr; n = n->next) {
+    nodes.push_back(n);
+  }
+
+  // largest objects get first use of the budget
+  std::vector<OptNode*> candidates;
+  for (OptNode* n = node_list; n != nullptr; n = n->next) {
+    if (n->type == NODE_OBJECT) { candidates.push_back(n); }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const OptNode* x, const OptNode* y){
+                     return x->box.weight() > y->box.weight(); });
+
+  // find pieces before changing any boxes
+  std::vector<std::pair<OptNode*,std::vector<BBox>>> splits;
+  std::vector<const OptNode*> others;
+  for (OptNode* c : candidates) {
+    if (budget <= 0) { break; }
+
+    others.clear();
+    for (const OptNode* n : nodes) { if (n != c) { others.push_back(n); } }
+
+    std::vector<BBox> pieces;
+    splitBox(*c->object, c->box, others, 0, budget, pieces);
+    if (pieces.size() > 1) { splits.emplace_back(c, std::move(pieces)); }
+  }
+
+  int refs = 0;
+  for (auto& [c,pieces] : splits) {
+    c->box = pieces[0];
+    c->split = true;
+    for (std::size_t i = 1; i < pieces.size(); ++i) {
+      OptNode* n = new OptNode{NODE_OBJECT, c->object, c->objHitCost};
+      n->box = pieces[i];
+      n->split = true;
+      n->next = c->next;
+      c->next = n;
+      ++refs;
+    }
+  }
+
+  return refs;
+}
+
 [[nodiscard]] static OptNode* makeOptNodeList(
   const Scene& s, std::span<const ObjectPtr> o_list)
 {
@@ -149,6 +317,33 @@ static Flt treeCost(const OptNode* node_list, Flt bound_weight)
   return node_list;
 }
 
+static void makeOccluderList(const OptNode* node_list, Bound& b)
+{
+  // objects sorted by chance of blocking a ray for its hit cost
+  // (node list & bound object list are in the same order)
+  std::vector<std::pair<Flt,const Object*>> ranked;
+  std::vector<const Object*> bounds;
+  std::size_t i = 0;
+  for (const OptNode* n = node_list; n != nullptr; n = n->next, ++i) {
+    const Object* ob = b.objects[i].get();
+    if (n->type == NODE_BOUND) {
+      bounds.push_back(ob);
+    } else {
+      ranked.emplace_back(
+        n->box.weight() / std::max(n->objHitCost, VERY_SMALL), ob);
+    }
+  }
+
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](const auto& x, const auto& y){
+                     return x.first > y.first; });
+
+  b.occluders.clear();
+  b.occluders.reserve(b.objects.size());
+  for (auto& r : ranked) { b.occluders.push_back(r.second); }
+  b.occluders.insert(b.occluders.end(), bounds.begin(), bounds.end());
+}
+
 static int convertNodeList(
   const OptNode* node_list, std::vector<ObjectPtr>& bound_list, BBox* bound_box)
 {
@@ -157,7 +352,11 @@ static int convertNodeList(
   int bound_count = 0;
   for (const OptNode* n = node_list; n != nullptr; n = n->next) {
     if (n->type == NODE_OBJECT) {
-      bound_list.push_back(n->object);
+      if (n->split) {
+        bound_list.push_back(makeObject<SplitObject>(n->object));
+      } else {
+        bound_list.push_back(n->object);
+      }
       if (bound_box) { bound_box->fit(n->box); }
     } else if (n->type == NODE_UNION) {
       auto u = makeObject<Union>();
@@ -167,6 +366,7 @@ static int convertNodeList(
     } else { // n->type == NODE_BOUND
       auto b = makeObject<Bound>();
       bound_count += 1 + convertNodeList(n->child, b->objects, &b->box);
+      makeOccluderList(n->child, *b);
       if (bound_box) { bound_box->fit(b->box); }
       bound_list.push_back(std::move(b));
     }
@@ -176,6 +376,187 @@ static int convertNodeList(
 }
 
 
+// **** Compressed Bounds ****
+namespace {
+  struct QItem {
+    BBox box;
+    std::vector<const Object*> leaf;  // objects of leaf item
+    Bound* bound = nullptr;           // or child bound
+    const OptNode* child = nullptr;   // child bound node list
+  };
+
+  struct QStats {
+    int bounds = 0, failed = 0;
+    std::size_t boundMemory = 0;
+
+    void add(const Bound& b) {
+      ++bounds;
+      boundMemory += sizeof(Bound)
+        + (b.objects.capacity() * sizeof(ObjectPtr))
+        + (b.occluders.capacity() * sizeof(const Object*));
+    }
+  };
+}
+
+[[nodiscard]] static bool isLeafBound(const Bound& b)
+{
+  // bounds of only objects are stored as a leaf in the parent node
+  // (avoids a node & box test - these bounds aren't compressed)
+  if (b.objects.size() > QuantizedBounds::MAX_LEAF_SIZE) { return false; }
+  return std::none_of(b.objects.begin(), b.objects.end(),
+                      [](const ObjectPtr& ob){
+                        return dynamic_cast<const Bound*>(ob.get()); });
+}
+
+[[nodiscard]] static bool compressBound(
+  QuantizedBounds& qb, Bound& b, const OptNode* node_list, int depth,
+  QStats& stats);
+
+[[nodiscard]] static bool compressItem(
+  QuantizedBounds& qb, uint32_t node, const BBox& nodeBox, int slot,
+  QItem& item, int depth, QStats& stats)
+{
+  if (item.bound && isLeafBound(*item.bound)) {
+    stats.add(*item.bound);
+    qb.setChild(node, nodeBox, slot, item.box,
+                qb.addLeaf(item.bound->occluders));
+    return true;
+  } else if (item.bound) {
+    const uint32_t child = qb.addNode();
+    item.bound->qnode = child;
+    item.bound->qbox = qb.setChild(node, nodeBox, slot, item.box, child);
+    return compressBound(qb, *item.bound, item.child, depth + 1, stats);
+  }
+
+  qb.setChild(node, nodeBox, slot, item.box, qb.addLeaf(item.leaf));
+  return true;
+}
+
+[[nodiscard]] static bool compressItems(
+  QuantizedBounds& qb, uint32_t node, const BBox& nodeBox,
+  std::span<QItem> items, int depth, QStats& stats)
+{
+  if (depth > QuantizedBounds::MAX_DEPTH) { return false; }
+  if (items.size() <= 2) {
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      if (!compressItem(qb, node, nodeBox, int(i), items[i], depth, stats)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // split items in half along the widest axis of the item centers
+  BBox centers;
+  for (auto& i : items) { centers.fit(i.box.center()); }
+  const Vec3 ext = centers.pmax - centers.pmin;
+  const unsigned int axis = (ext.x > ext.y)
+    ? ((ext.x > ext.z) ? 0 : 2) : ((ext.y > ext.z) ? 1 : 2);
+  std::sort(items.begin(), items.end(),
+            [axis](const QItem& x, const QItem& y){
+              return x.box.center()[axis] < y.box.center()[axis]; });
+
+  const std::size_t mid = items.size() / 2;
+  const std::span<QItem> halves[2] = {
+    items.subspan(0, mid), items.subspan(mid)};
+  for (int slot = 0; slot < 2; ++slot) {
+    const std::span<QItem> h = halves[slot];
+    if (h.size() == 1) {
+      if (!compressItem(qb, node, nodeBox, slot, h[0], depth, stats)) {
+        return false;
+      }
+      continue;
+    }
+
+    BBox box;
+    for (auto& i : h) { box.fit(i.box); }
+    const uint32_t child = qb.addNode();
+    const BBox childBox = qb.setChild(node, nodeBox, slot, box, child);
+    if (!compressItems(qb, child, childBox, h, depth + 1, stats)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool compressBound(
+  QuantizedBounds& qb, Bound& b, const OptNode* node_list, int depth,
+  QStats& stats)
+{
+  if (depth > QuantizedBounds::MAX_DEPTH) { return false; }
+  stats.add(b);
+
+  // child bounds are items, other objects are grouped into leaves
+  // (in occluder order - node list & bound objects are in the same order)
+  std::vector<QItem> items;
+  BBox leafBox;
+  std::size_t i = 0;
+  for (const OptNode* n = node_list; n != nullptr; n = n->next, ++i) {
+    if (n->type == NODE_BOUND) {
+      items.push_back(
+        {n->box, {}, dynamic_cast<Bound*>(b.objects[i].get()), n->child});
+    } else {
+      leafBox.fit(n->box);
+    }
+  }
+
+  const std::size_t leafCount = b.occluders.size() - items.size();
+  for (std::size_t x = 0; x < leafCount;
+       x += QuantizedBounds::MAX_LEAF_SIZE) {
+    const std::size_t end =
+      std::min(leafCount, x + QuantizedBounds::MAX_LEAF_SIZE);
+    items.push_back({leafBox, {b.occluders.begin() + long(x),
+                               b.occluders.begin() + long(end)}});
+  }
+
+  return compressItems(qb, b.qnode, b.qbox, items, depth, stats);
+}
+
+static void setQuantized(
+  Bound& b, const std::shared_ptr<const QuantizedBounds>& qb)
+{
+  if (isLeafBound(b)) { return; }
+
+  b.qbounds = qb;
+  for (auto& ob : b.objects) {
+    auto cb = dynamic_cast<Bound*>(ob.get());
+    if (cb) { setQuantized(*cb, qb); }
+  }
+}
+
+static void compressBoundList(
+  const OptNode* node_list, std::span<const ObjectPtr> bound_list,
+  const std::string& tag)
+{
+  auto qb = std::make_shared<QuantizedBounds>();
+  QStats stats;
+  std::size_t i = 0;
+  for (const OptNode* n = node_list; n != nullptr; n = n->next, ++i) {
+    if (n->type != NODE_BOUND) { continue; }
+
+    auto b = dynamic_cast<Bound*>(bound_list[i].get());
+    if (isLeafBound(*b)) { continue; }
+
+    b->qnode = qb->addNode();
+    b->qbox = b->box;
+    if (compressBound(*qb, *b, n->child, 0, stats)) {
+      setQuantized(*b, qb);
+    } else {
+      ++stats.failed;
+    }
+  }
+
+  if (qb->empty()) { return; }
+  println("Compressed bounds", tag, ": ", stats.bounds, " (", qb->nodeCount(),
+          " nodes, ", qb->memorySize() / 1024, "K vs ",
+          stats.boundMemory / 1024, "K)");
+  if (stats.failed > 0) {
+    println("Compressed bound trees too deep", tag, ": ", stats.failed);
+  }
+}
+
+
 class OptNodeTree
 {
  public:
@@ -192,10 +573,17 @@ class OptNodeTree
   [[nodiscard]] explicit operator bool() const { return _head != nullptr; }
 
   [[nodiscard]] Flt cost() const { return treeCost(_head, _sceneWeight); }
+  int split(Flt budget) {
+    return splitLargeNodes(_head, int(Flt(countNodes(_head)) * budget)); }
+    // budget is extra object references allowed (fraction of node count)
   void optimize() { optimizeOptNodeList(_head, _sceneWeight); }
 
   int makeBoundList(std::vector<ObjectPtr>& bound_list) const {
     return convertNodeList(_head, bound_list, nullptr); }
+  void compress(std::span<const ObjectPtr> bound_list,
+                const std::string& tag) const {
+    compressBoundList(_head, bound_list, tag); }
+    // bound_list must be from makeBoundList()
 
  private:
   OptNode* _head = nullptr;
@@ -310,15 +698,52 @@ OptNode* OptNodeTree::mergeOptNodes(OptNode* node1, OptNode* node2)
 
 // **** Functions ****
 int makeBoundList(const Scene& s, std::span<const ObjectPtr> o_list,
-                  std::vector<ObjectPtr>& bound_list)
+                  std::vector<ObjectPtr>& bound_list, std::string_view label)
 {
   OptNodeTree tree{s, o_list};
   if (!tree) { return 0; }
 
-  println("Old tree cost: ", tree.cost());
+  const std::string tag = label.empty() ? "" : concat(" (", label, ')');
+  const int refs = tree.split(s.split_budget);
+  if (refs > 0) { println("Split references", tag, ": ", refs); }
+
+  println("Old tree cost", tag, ": ", tree.cost());
   tree.optimize();
-  println("New tree cost: ", tree.cost());
+  println("New tree cost", tag, ": ", tree.cost());
 
   bound_list.clear();
-  return tree.makeBoundList(bound_list);
+  const int count = tree.makeBoundList(bound_list);
+  tree.compress(bound_list, tag);
+  return count;
+}
+
+void cullBoundList(const Frustum& f, std::span<const ObjectPtr> bound_list,
+                   std::vector<const Object*>& result)
+{
+  for (auto& ob : bound_list) {
+    auto b = dynamic_cast<const Bound*>(ob.get());
+    if (!b) { result.push_back(ob.get()); continue; }
+
+    // step down tree while only one child bound is visible
+    // (bound test is redundant for a single child bound)
+    for (;;) {
+      const FrustumTest t = f.test(b->box);
+      if (t == FRUSTUM_OUTSIDE) { b = nullptr; break; }
+      if (t == FRUSTUM_INSIDE) { break; }
+
+      const Bound* visible = nullptr;
+      for (auto& c : b->objects) {
+        auto cb = dynamic_cast<const Bound*>(c.get());
+        if (!cb) { visible = b; break; }
+        if (f.test(cb->box) == FRUSTUM_OUTSIDE) { continue; }
+        if (visible) { visible = b; break; }
+        visible = cb;
+      }
+
+      if (!visible || visible == b) { break; }
+      b = visible;
+    }
+
+    if (b) { result.push_back(b); }
+  }
 }
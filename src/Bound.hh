@@ -10,25 +10,52 @@
 #include "Object.hh"
 #include "BBox.hh"
 #include <vector>
+#include <memory>
+#include <string_view>
+#include <cstdint>
 
 
 // **** Types ****
+class Frustum;
+class QuantizedBounds;
+
 class Bound final : public Object
 {
  public:
   std::vector<ObjectPtr> objects;
+  std::vector<const Object*> occluders;
+    // objects in shadow ray test order
+    // (likely occluders first - projected area / hit cost, then bounds)
   BBox box; // bound size
 
+  // compressed hierarchy used for traversal if set
+  // (qbox is the decoded node box - slightly larger than box)
+  std::shared_ptr<const QuantizedBounds> qbounds;
+  uint32_t qnode = 0;
+  BBox qbox;
+
   // SceneItem Functions
   std::string desc() const override;
 
   // Object Functions
   BBox bound(const Matrix* t) const override { return box; }
   int intersect(const Ray& r, HitList& hl) const override;
+  bool occludes(const Ray& r, HitList& hl) const override;
   std::span<const ObjectPtr> children() const override { return objects; }
+
+ private:
+  [[nodiscard]] bool hitBox(const Ray& r, StatInfo& stats) const;
 };
 
 
 // **** Functions ****
 int makeBoundList(const Scene& s, std::span<const ObjectPtr> o_list,
-                  std::vector<ObjectPtr>& bound_list);
+                  std::vector<ObjectPtr>& bound_list,
+                  std::string_view label = {});
+  // label is added to printed tree stats if scene has several lists
+
+void cullBoundList(const Frustum& f, std::span<const ObjectPtr> bound_list,
+                   std::vector<const Object*>& result);
+  // bound list objects that can be hit by rays inside frustum
+  // (a bound partly in frustum is replaced by its child bound if only one
+  //  child is visible - result references objects in bound_list tree)
@@ -10,9 +10,37 @@
 #include "BBox.hh"
 #include "Print.hh"
 #include "RegisterObject.hh"
+#include "Ray.hh"
+#include "Stats.hh"
+#include <algorithm>
 #include <cassert>
 
 
+// **** Helper Functions ****
+namespace {
+  struct Span { Flt near_hit, far_hit; };
+
+  [[nodiscard]] Span boxSpan(const BBox& b, const Ray& r, const Vec3& invDir)
+  {
+    // ray distances where box is entered & left
+    // (children can only have hits inside the span of their box)
+    const Vec3 h1 = (b.pmin - r.base) * invDir;
+    const Vec3 h2 = (b.pmax - r.base) * invDir;
+    return {
+      std::max({std::min(h1.x, h2.x), std::min(h1.y, h2.y),
+                std::min(h1.z, h2.z)}),
+      std::min({std::max(h1.x, h2.x), std::max(h1.y, h2.y),
+                std::max(h1.z, h2.z)})};
+  }
+
+  [[nodiscard]] bool missed(const Span& s, const Ray& r)
+  {
+    return s.near_hit > s.far_hit
+      || s.far_hit < r.min_length || s.near_hit >= r.max_length;
+  }
+}
+
+
 // **** CSG Class ****
 int CSG::addObject(const ObjectPtr& ob)
 {
@@ -33,8 +61,10 @@ int CSG::init(Scene& s, const Transform* tr)
     return -1;
   }
 
+  _boxes.clear();
   for (auto& ob : objects) {
     if (s.initObject(*ob, shader(), tr)) { return -1; }
+    _boxes.push_back(ob->bound(nullptr));
   }
 
   const BBox b = bound(nullptr);
@@ -131,8 +161,32 @@ BBox Intersection::bound(const Matrix* t) const
   return b;
 }
 
+BBox Intersection::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  assert(!objects.empty());
+  BBox b = objects[0]->clippedBound(axis, lo, hi);
+  for (std::size_t i = 1, size = objects.size(); i < size; ++i) {
+    b.intersect(objects[i]->clippedBound(axis, lo, hi));
+  }
+  return b;
+}
+
 int Intersection::intersect(const Ray& r, HitList& hl) const
 {
+  // no hits are possible if the ray misses a child box or the child box
+  // spans don't overlap
+  const Vec3 invDir = r.inverseDir();
+  Span all{-VERY_LARGE, VERY_LARGE};
+  for (const BBox& b : _boxes) {
+    const Span s = boxSpan(b, r, invDir);
+    all.near_hit = std::max(all.near_hit, s.near_hit);
+    all.far_hit = std::min(all.far_hit, s.far_hit);
+    if (missed(s, r) || all.near_hit > all.far_hit) {
+      hl.stats().csg_culled += objects.size();
+      return 0;
+    }
+  }
+
   HitList hl2{hl.cache(), hl.stats(), true};
   for (auto& ob : objects) { ob->intersect(r, hl2); }
   hl2.csgIntersection(this, int(objects.size()));
@@ -168,10 +222,33 @@ BBox Difference::bound(const Matrix* t) const
   }
 }
 
+BBox Difference::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  assert(!objects.empty());
+  return objects[0]->clippedBound(axis, lo, hi);
+}
+
 int Difference::intersect(const Ray& r, HitList& hl) const
 {
+  const Vec3 invDir = r.inverseDir();
+  const Span primary = boxSpan(_boxes[0], r, invDir);
+  if (missed(primary, r)) {
+    hl.stats().csg_culled += objects.size();
+    return 0;
+  }
+
+  // only test subtracted objects that can overlap the primary object
   HitList hl2{hl.cache(), hl.stats(), true};
-  for (auto& ob : objects) { ob->intersect(r, hl2); }
+  objects[0]->intersect(r, hl2);
+  for (std::size_t i = 1, size = objects.size(); i < size; ++i) {
+    const Span s = boxSpan(_boxes[i], r, invDir);
+    if (missed(s, r) || s.far_hit < primary.near_hit
+        || s.near_hit > primary.far_hit) {
+      ++hl.stats().csg_culled;
+      continue;
+    }
+    objects[i]->intersect(r, hl2);
+  }
   hl2.csgDifference(this, objects[0].get());
 
   if (hl.csg()) {
@@ -7,6 +7,7 @@
 
 #pragma once
 #include "Object.hh"
+#include "BBox.hh"
 #include <vector>
 
 
@@ -27,6 +28,9 @@ class CSG : public Primitive
   // Primitive Functions
   Flt hitCost(const HitCostInfo& hc) const final;
   Vec3 normal(const Ray& r, const HitInfo& h) const final { return {}; }
+
+ protected:
+  std::vector<BBox> _boxes;  // child object bounds (set by init)
 };
 
 
@@ -50,6 +54,7 @@ class Intersection final : public CSG
 
   // Object Functions
   BBox bound(const Matrix* t) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
   int intersect(const Ray& r, HitList& hl) const override;
 };
 
@@ -61,5 +66,6 @@ class Difference final : public CSG
 
   // Object Functions
   BBox bound(const Matrix* t) const override;
+  BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const override;
   int intersect(const Ray& r, HitList& hl) const override;
 };
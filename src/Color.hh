@@ -69,6 +69,11 @@ class Color
       + (blue() * static_cast<value_type>(.0722));
   }
 
+  [[nodiscard]] constexpr value_type maxValue() const {
+    const value_type rg = (red() > green()) ? red() : green();
+    return (rg > blue()) ? rg : blue();
+  }
+
   // low-level access
   [[nodiscard]] static constexpr size_type size() { return CHANNELS; }
 
@@ -0,0 +1,197 @@
+//
+// Denoise.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "Denoise.hh"
+#include "FrameBuffer.hh"
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+  // edge stopping function settings
+  constexpr float LUMINANCE_SIGMA = 2.0f; // lighting difference in std devs
+  constexpr float NORMAL_SIGMA = .3f;     // normal vector difference
+  constexpr float DEPTH_SIGMA = .02f;     // relative depth change per pixel
+  constexpr float ALBEDO_SIGMA = .2f;     // relative surface color difference
+  constexpr float MIN_STD_DEV = .001f;    // noise free lighting
+  constexpr float MIN_EXPONENT = -16.0f;  // smaller weights are skipped
+
+  // B3 spline kernel
+  constexpr float KERNEL[5] = {1.0f/16.0f, 1.0f/4.0f, 3.0f/8.0f, 1.0f/4.0f,
+                               1.0f/16.0f};
+
+  [[nodiscard]] Color modulate(
+    const Color& c, const Color& specular, const Color& albedo)
+  {
+    return {(c[0] * std::max(albedo[0], MIN_ALBEDO)) + specular[0],
+            (c[1] * std::max(albedo[1], MIN_ALBEDO)) + specular[1],
+            (c[2] * std::max(albedo[2], MIN_ALBEDO)) + specular[2]};
+  }
+}
+
+
+// **** Denoiser Class ****
+void Denoiser::init(int width, int height,
+                    int min_x, int min_y, int max_x, int max_y)
+{
+  _width = width;
+  _height = height;
+  _minX = std::max(min_x, 0);
+  _minY = std::max(min_y, 0);
+  _maxX = std::min(max_x, width - 1);
+  _maxY = std::min(max_y, height - 1);
+
+  const auto size = std::size_t(width * height);
+  _guides.assign(size, PixelGuide{});
+  _surfaces.resize(size);
+  for (int i = 0; i < 2; ++i) {
+    _color[i].resize(size);
+    _variance[i].resize(size);
+  }
+}
+
+float Denoiser::surfaceTerm(std::size_t i, std::size_t j, float dist) const
+{
+  const Surface& p = _surfaces[i];
+  const Surface& q = _surfaces[j];
+
+  const float dn = sqr(p.nx - q.nx) + sqr(p.ny - q.ny) + sqr(p.nz - q.nz);
+
+  // depth difference relative to expected change over distance
+  const float dz = std::abs(p.depth - q.depth)
+    / ((std::max(p.depth, q.depth) * DEPTH_SIGMA * dist) + 1.0e-20f);
+
+  // albedo difference relative to albedo brightness
+  // (dark albedo amplifies lighting so small differences matter)
+  const float da = (sqr(p.ax - q.ax) + sqr(p.ay - q.ay) + sqr(p.az - q.az))
+    / (p.albedoLen2 + q.albedoLen2 + 1.0e-20f);
+
+  return -(dn * (1.0f / sqr(NORMAL_SIGMA)))
+    - (da * (1.0f / sqr(ALBEDO_SIGMA))) - dz;
+}
+
+void Denoiser::load(const FrameBuffer& fb)
+{
+  for (int y = _minY; y <= _maxY; ++y) {
+    for (int x = _minX; x <= _maxX; ++x) {
+      const std::size_t i = index(x, y);
+      const PixelGuide& g = _guides[i];
+      _color[0][i] = demodulate(fb.value(x, y), g.specular, g.albedo);
+
+      const Color& a = g.albedo;
+      _surfaces[i] = {
+        float(g.normal.x), float(g.normal.y), float(g.normal.z),
+        float(g.depth), a[0], a[1], a[2],
+        sqr(a[0]) + sqr(a[1]) + sqr(a[2])};
+    }
+  }
+
+  // pixel variance
+  // (estimated from 5x5 neighborhood of the same surface if a pixel only
+  //  had a single sample)
+  for (int y = _minY; y <= _maxY; ++y) {
+    for (int x = _minX; x <= _maxX; ++x) {
+      const std::size_t i = index(x, y);
+      if (_guides[i].variance >= 0.0) {
+        _variance[0][i] = float(_guides[i].variance);
+        continue;
+      }
+
+      float sum = 0, sum2 = 0, weightSum = 0;
+      for (int qy = std::max(y - 2, _minY);
+           qy <= std::min(y + 2, _maxY); ++qy) {
+        for (int qx = std::max(x - 2, _minX);
+             qx <= std::min(x + 2, _maxX); ++qx) {
+          const std::size_t j = index(qx, qy);
+          const float w = std::exp(surfaceTerm(
+            i, j, float(std::max(Abs(qx - x), Abs(qy - y)))));
+          const float l = _color[0][j].cieLuminance();
+          sum += l * w;
+          sum2 += l * l * w;
+          weightSum += w;
+        }
+      }
+
+      const float mean = sum / weightSum;
+      _variance[0][i] = std::max((sum2 / weightSum) - sqr(mean), 0.0f);
+    }
+  }
+}
+
+void Denoiser::filter(int pass, int min_x, int min_y, int max_x, int max_y)
+{
+  const int step = 1 << pass;
+  const std::vector<Color>& src = _color[pass & 1];
+  const std::vector<float>& srcVar = _variance[pass & 1];
+  std::vector<Color>& dst = _color[(pass + 1) & 1];
+  std::vector<float>& dstVar = _variance[(pass + 1) & 1];
+
+  min_x = std::max(min_x, _minX);
+  min_y = std::max(min_y, _minY);
+  max_x = std::min(max_x, _maxX);
+  max_y = std::min(max_y, _maxY);
+  for (int y = min_y; y <= max_y; ++y) {
+    for (int x = min_x; x <= max_x; ++x) {
+      const std::size_t i = index(x, y);
+      const float lp = src[i].cieLuminance();
+
+      // lighting std deviation from 3x3 blurred variance
+      // (single pixel variance estimates are noisy)
+      float var = 0, varWeight = 0;
+      for (int qy = std::max(y - 1, _minY);
+           qy <= std::min(y + 1, _maxY); ++qy) {
+        for (int qx = std::max(x - 1, _minX);
+             qx <= std::min(x + 1, _maxX); ++qx) {
+          const float w = KERNEL[qx - x + 2] * KERNEL[qy - y + 2];
+          var += srcVar[index(qx, qy)] * w;
+          varWeight += w;
+        }
+      }
+      const float stdDev = std::sqrt(var / varWeight);
+      const float lumScale =
+        -1.0f / ((LUMINANCE_SIGMA * stdDev) + MIN_STD_DEV);
+
+      Color sum{colors::black};
+      float varSum = 0, weightSum = 0;
+      for (int ky = -2; ky <= 2; ++ky) {
+        const int qy = y + (ky * step);
+        if (qy < _minY || qy > _maxY) { continue; }
+
+        for (int kx = -2; kx <= 2; ++kx) {
+          const int qx = x + (kx * step);
+          if (qx < _minX || qx > _maxX) { continue; }
+
+          const std::size_t j = index(qx, qy);
+          const Color& cq = src[j];
+          const float e = surfaceTerm(
+            i, j, float(step * std::max(Abs(kx), Abs(ky))))
+            + (std::abs(lp - cq.cieLuminance()) * lumScale);
+          if (e < MIN_EXPONENT) { continue; }
+
+          const float w = KERNEL[kx + 2] * KERNEL[ky + 2] * std::exp(e);
+          sum += cq * w;
+          varSum += srcVar[j] * w * w;
+          weightSum += w;
+        }
+      }
+
+      // center pixel always has full weight so weightSum is never zero
+      dst[i] = sum / weightSum;
+      dstVar[i] = varSum / sqr(weightSum);
+    }
+  }
+}
+
+void Denoiser::store(FrameBuffer& fb, int passes) const
+{
+  const std::vector<Color>& src = _color[passes & 1];
+  for (int y = _minY; y <= _maxY; ++y) {
+    for (int x = _minX; x <= _maxX; ++x) {
+      const std::size_t i = index(x, y);
+      const PixelGuide& g = _guides[i];
+      fb.plot(x, y, modulate(src[i], g.specular, g.albedo));
+    }
+  }
+}
@@ -0,0 +1,85 @@
+//
+// Denoise.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// edge-aware a-trous wavelet denoise filter (Dammertz et al. 2010)
+// guided by per-pixel normal, depth & albedo buffers from the render
+// with variance guided color weights (SVGF - Schied et al. 2017)
+//
+
+#pragma once
+#include "Color.hh"
+#include "Types.hh"
+#include <algorithm>
+#include <vector>
+
+
+// **** Types ****
+struct PixelGuide {
+  Vec3 normal{0,0,0};  // average primary hit normal (zero for background)
+  Flt depth = 0;       // average primary hit distance (zero for background)
+  Color albedo;        // average unlit surface color
+  Color specular;      // average specular/reflection color (not filtered)
+  Flt variance = -1;   // variance of pixel lighting luminance
+                       // (negative if unknown - estimated from neighbors)
+};
+
+constexpr Color::value_type MIN_ALBEDO = .02f;
+  // keeps lighting finite for black surfaces
+
+[[nodiscard]] constexpr Color demodulate(
+  const Color& c, const Color& specular, const Color& albedo)
+{
+  // diffuse lighting of surface (color with specular part removed &
+  // albedo divided out)
+  return {(c[0] - specular[0]) / std::max(albedo[0], MIN_ALBEDO),
+          (c[1] - specular[1]) / std::max(albedo[1], MIN_ALBEDO),
+          (c[2] - specular[2]) / std::max(albedo[2], MIN_ALBEDO)};
+}
+
+class Denoiser
+{
+ public:
+  // Member Functions
+  void init(int width, int height,
+            int min_x, int min_y, int max_x, int max_y);
+    // sets image size & region filtered (guides are cleared)
+
+  void setGuide(int x, int y, const PixelGuide& g) {
+    _guides[index(x, y)] = g; }
+
+  void load(const FrameBuffer& fb);
+    // copies render result as diffuse lighting & prepares guides
+    // (only lighting is filtered so texture & reflection detail isn't
+    //  blurred)
+
+  void filter(int pass, int min_x, int min_y, int max_x, int max_y);
+    // runs filter pass for part of the region
+    // (passes must be run in order but a single pass can be split into
+    //  regions filtered in parallel)
+
+  void store(FrameBuffer& fb, int passes) const;
+    // writes result of last pass back with albedo & specular restored
+
+ private:
+  struct Surface {
+    // compact guide values used by filter
+    float nx, ny, nz;
+    float depth;
+    float ax, ay, az;
+    float albedoLen2;  // albedo length squared
+  };
+
+  std::vector<PixelGuide> _guides;
+  std::vector<Surface> _surfaces;
+  std::vector<Color> _color[2];  // filter input/output for each pass
+  std::vector<float> _variance[2];
+  int _width = 0, _height = 0;
+  int _minX = 0, _minY = 0, _maxX = -1, _maxY = -1;
+
+  [[nodiscard]] std::size_t index(int x, int y) const {
+    return std::size_t((y * _width) + x); }
+  [[nodiscard]] float surfaceTerm(
+    std::size_t i, std::size_t j, float dist) const;
+    // weight exponent for surface differences of pixels i & j
+};
@@ -0,0 +1,102 @@
+//
+// Filter.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "Filter.hh"
+#include <utility>
+#include <cmath>
+
+
+namespace {
+  constexpr std::pair<std::string_view,FilterType> FILTER_TYPES[] = {
+    {"box",            FILTER_BOX},
+    {"gaussian",       FILTER_GAUSSIAN},
+    {"mitchell",       FILTER_MITCHELL},
+    {"blackmanharris", FILTER_BLACKMAN_HARRIS}
+  };
+
+  [[nodiscard]] Flt defaultRadius(FilterType t)
+  {
+    switch (t) {
+      default:
+      case FILTER_BOX:             return .5;
+      case FILTER_GAUSSIAN:        return 1.5;
+      case FILTER_MITCHELL:        return 2.0;
+      case FILTER_BLACKMAN_HARRIS: return 2.0;
+    }
+  }
+
+  [[nodiscard]] Flt mitchell(Flt x)
+  {
+    // Mitchell-Netravali cubic for x in [0,2]
+    constexpr Flt B = 1.0 / 3.0, C = 1.0 / 3.0;
+    if (x < 1.0) {
+      return (((12.0 - (9.0 * B) - (6.0 * C)) * x * x * x)
+              + ((-18.0 + (12.0 * B) + (6.0 * C)) * x * x)
+              + (6.0 - (2.0 * B))) / 6.0;
+    } else if (x < 2.0) {
+      return (((-B - (6.0 * C)) * x * x * x)
+              + (((6.0 * B) + (30.0 * C)) * x * x)
+              + (((-12.0 * B) - (48.0 * C)) * x)
+              + ((8.0 * B) + (24.0 * C))) / 6.0;
+    }
+    return 0.0;
+  }
+
+  [[nodiscard]] Flt filterValue(FilterType t, Flt x, Flt radius)
+  {
+    switch (t) {
+      default:
+      case FILTER_BOX:
+        return 1.0;
+
+      case FILTER_GAUSSIAN: {
+        const Flt a = -.5 / sqr(radius / 3.0);
+        return std::exp(a * x * x) - std::exp(a * radius * radius);
+      }
+
+      case FILTER_MITCHELL:
+        return mitchell(2.0 * x / radius);
+
+      case FILTER_BLACKMAN_HARRIS: {
+        const Flt a = PI * ((x / radius) + 1.0);  // 2pi * [0,1] position
+        return .35875 - (.48829 * std::cos(a)) + (.14128 * std::cos(2.0 * a))
+          - (.01168 * std::cos(3.0 * a));
+      }
+    }
+  }
+}
+
+
+// **** PixelFilter Class ****
+void PixelFilter::init(FilterType t, Flt radius)
+{
+  _type = t;
+  _radius = isPositive(radius) ? radius : defaultRadius(t);
+  _tableScale = Flt(TABLE_SIZE) / _radius;
+
+  // table of filter values at center of each interval
+  for (int i = 0; i < TABLE_SIZE; ++i) {
+    const Flt x = (Flt(i) + .5) / _tableScale;
+    _table[i] = float(filterValue(t, x, _radius));
+  }
+}
+
+
+// **** Functions ****
+bool findFilterType(std::string_view name, FilterType& type)
+{
+  for (auto& [n,t] : FILTER_TYPES) {
+    if (n == name) { type = t; return true; }
+  }
+  return false;
+}
+
+std::string_view filterName(FilterType type)
+{
+  for (auto& [n,t] : FILTER_TYPES) {
+    if (t == type) { return n; }
+  }
+  return "unknown";
+}
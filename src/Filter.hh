@@ -0,0 +1,54 @@
+//
+// Filter.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// pixel reconstruction filters for splatting samples into nearby pixels
+//
+// box            - samples only count for their own pixel (no splatting)
+// gaussian       - gaussian (sigma = radius/3) shifted to zero at radius
+// mitchell       - Mitchell-Netravali cubic (B = C = 1/3)
+// blackmanharris - 4 term Blackman-Harris window
+//
+
+#pragma once
+#include "Types.hh"
+#include <string_view>
+
+
+// **** Types ****
+enum FilterType {
+  FILTER_BOX, FILTER_GAUSSIAN, FILTER_MITCHELL, FILTER_BLACKMAN_HARRIS
+};
+
+class PixelFilter
+{
+ public:
+  // Member Functions
+  void init(FilterType t, Flt radius);
+    // radius of zero uses default radius for filter type
+
+  [[nodiscard]] FilterType type() const { return _type; }
+  [[nodiscard]] Flt radius() const { return _radius; }
+  [[nodiscard]] bool splat() const { return _type != FILTER_BOX; }
+
+  [[nodiscard]] float operator()(Flt dx, Flt dy) const {
+    return weight1D(dx) * weight1D(dy); }
+    // filter weight for sample offset from pixel center
+
+ private:
+  static constexpr int TABLE_SIZE = 64;
+
+  float _table[TABLE_SIZE] = {};
+  FilterType _type = FILTER_BOX;
+  Flt _radius = .5;
+  Flt _tableScale = 0;
+
+  [[nodiscard]] float weight1D(Flt x) const {
+    const Flt i = Abs(x) * _tableScale;
+    return (i < Flt(TABLE_SIZE)) ? _table[int(i)] : 0.0f; }
+};
+
+
+// **** Functions ****
+[[nodiscard]] bool findFilterType(std::string_view name, FilterType& type);
+[[nodiscard]] std::string_view filterName(FilterType type);
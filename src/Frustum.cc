@@ -0,0 +1,41 @@
+//
+// Frustum.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "Frustum.hh"
+#include "BBox.hh"
+
+
+// **** Frustum Class ****
+void Frustum::init(const Vec3& apex, const Vec3 (&corners)[4])
+{
+  _apex = apex;
+  const Vec3 center = corners[0] + corners[1] + corners[2] + corners[3];
+  for (int i = 0; i < 4; ++i) {
+    const Vec3 n = crossProduct(corners[i], corners[(i + 1) & 3]);
+    _normal[i] = (dotProduct(n, center) < 0.0) ? -n : n;
+  }
+}
+
+FrustumTest Frustum::test(const BBox& box) const
+{
+  const Vec3 pmin = box.pmin - _apex;
+  const Vec3 pmax = box.pmax - _apex;
+
+  bool inside = true;
+  for (const Vec3& n : _normal) {
+    // box corners furthest inside & outside of plane
+    const Flt far = ((n.x > 0.0) ? pmax.x : pmin.x) * n.x
+      + ((n.y > 0.0) ? pmax.y : pmin.y) * n.y
+      + ((n.z > 0.0) ? pmax.z : pmin.z) * n.z;
+    if (far < 0.0) { return FRUSTUM_OUTSIDE; }
+
+    const Flt near = ((n.x > 0.0) ? pmin.x : pmax.x) * n.x
+      + ((n.y > 0.0) ? pmin.y : pmax.y) * n.y
+      + ((n.z > 0.0) ? pmin.z : pmax.z) * n.z;
+    if (near < 0.0) { inside = false; }
+  }
+
+  return inside ? FRUSTUM_INSIDE : FRUSTUM_PARTIAL;
+}
@@ -0,0 +1,31 @@
+//
+// Frustum.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// pyramid of rays from a single point (used to cull objects for the
+// primary rays of an image tile)
+//
+
+#pragma once
+#include "Types.hh"
+
+
+// **** Types ****
+class BBox;
+
+enum FrustumTest { FRUSTUM_OUTSIDE, FRUSTUM_PARTIAL, FRUSTUM_INSIDE };
+
+class Frustum
+{
+ public:
+  // Member Functions
+  void init(const Vec3& apex, const Vec3 (&corners)[4]);
+    // corners are ray directions at the frustum edges in order around it
+
+  [[nodiscard]] FrustumTest test(const BBox& box) const;
+    // conservative - boxes near the frustum may be partial
+
+ private:
+  Vec3 _apex{INIT_NONE};
+  Vec3 _normal[4];  // side plane normals (pointing in)
+};
@@ -6,6 +6,7 @@
 #pragma once
 #include "ListUtil.hh"
 #include "Types.hh"
+#include <vector>
 #include <utility>
 
 
@@ -49,6 +50,10 @@ class HitCache
   void storeList(HitInfo* head, HitInfo* tail) {
     tail->next = _head; _head = head; }
 
+  [[nodiscard]] std::vector<const Object*>& tested() { return _tested; }
+    // objects tested by active hit lists (see HitList::firstTest())
+
  private:
   HitInfo* _head = nullptr;
+  std::vector<const Object*> _tested;
 };
@@ -5,6 +5,7 @@
 
 #include "Intersect.hh"
 #include "Ray.hh"
+#include <algorithm>
 
 
 // **** HitList Class ****
@@ -37,6 +38,18 @@ void HitList::clear()
   }
 }
 
+bool HitList::firstTest(const Object* ob)
+{
+  // hit lists of a job are nested (CSG lists) so objects tested by this
+  // list are at the end of the cache list
+  auto& tested = _cache->tested();
+  const auto start = tested.begin() + std::ptrdiff_t(_testedStart);
+  if (std::find(start, tested.end(), ob) != tested.end()) { return false; }
+
+  tested.push_back(ob);
+  return true;
+}
+
 HitInfo* HitList::removeFirstHit(const Ray& r)
 {
   HitInfo* prev = nullptr;
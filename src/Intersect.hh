@@ -16,8 +16,9 @@ class HitList
 {
  public:
   HitList(HitCache& cache, StatInfo& stats, bool csg)
-    : _cache{&cache}, _stats{&stats}, _csg{csg} { }
-  ~HitList() { clear(); }
+    : _cache{&cache}, _stats{&stats}, _testedStart{cache.tested().size()},
+      _csg{csg} { }
+  ~HitList() { clear(); _cache->tested().resize(_testedStart); }
 
   // Member Functions
   void addHit(const Primitive* ob, Flt t, const Vec3& local_pt, int side,
@@ -50,10 +51,16 @@ class HitList
   [[nodiscard]] HitCache& cache() { return *_cache; }
   [[nodiscard]] StatInfo& stats() { return *_stats; }
 
+  [[nodiscard]] bool firstTest(const Object* ob);
+    // false if ob was already tested with this hit list
+    // (for objects referenced by several bounds - tested objects are kept
+    //  in cache until hit list is destroyed)
+
  private:
   SList<HitInfo> _hitList;
   HitCache* _cache;
   StatInfo* _stats;
+  std::size_t _testedStart; // first object in cache tested() list
   bool _csg;
 
   [[nodiscard]] HitInfo* newHit(Flt t);
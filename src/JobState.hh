@@ -7,34 +7,171 @@
 
 #pragma once
 #include "HitInfo.hh"
+#include "ObjectPtr.hh"
+#include "Ray.hh"
+#include "Color.hh"
 #include "Stats.hh"
-#include "RandomDist.hh"
+#include "Sampler.hh"
+#include "Random.hh"
 #include "Types.hh"
+#include <vector>
+#include <span>
+
+class Light;
+class Object;
+class ShadowGrid;
 
 
 struct JobState
 {
   HitCache cache;
   StatInfo stats;
+  std::vector<const Light*> lightList;  // Scene::lightsAt() results
+  std::vector<Flt> lightWeights;        // light sampling weights
+  std::vector<const Object*> shadowCache;  // last occluder for each light
+
+  // msaa pixel sample groups
+  struct SampleGroup {
+    HitInfo hit;    // hit.object is null for background
+    Ray ray;        // sample closest to pixel center
+    RayDifferentials diff;  // ray.diff is pointed here when shaded
+    Vec3 normal;    // surface normal of first sample
+    Color color;    // shaded result (used for splatting)
+    Flt centerDist;
+    int sample;
+    int count;
+  };
+  std::vector<SampleGroup> sampleGroups;
+
+  // reconstruction filter tile buffer
+  // (samples are splatted into every pixel in filter radius, alpha holds
+  //  the filter weight sum - region rendered plus an apron of filter
+  //  radius is merged into Renderer buffer after each render call)
+  std::vector<Color> splatBuffer;
+  int splatX = 0, splatY = 0, splatW = 0, splatH = 0;
+
+  struct GroupSample {
+    Vec2 pos;  // film position
+    int group;
+  };
+  std::vector<GroupSample> groupSamples;  // msaa samples to splat
+
+  // wavefront render queues
+  // (while rendering a tile breadth first, shaders queue reflection rays
+  //  & lights queue shadow rays instead of tracing them - results are
+  //  added to the tile pixels scaled by the path weight of the ray)
+  struct QueuedRay {
+    Ray ray;
+    RayDifferentials diff;  // ray.diff is pointed here when shaded
+    Color weight;  // path weight (includes pixel sample weight)
+    int pixel;     // tile pixel index
+    int sample;
+  };
+  struct QueuedShadow {
+    Vec3 base, dir;
+    Flt min_length, max_length;
+    Color value;   // weighted light result added if ray isn't blocked
+    const ShadowGrid* grid;
+    int light;
+    int pixel;
+  };
+  std::vector<QueuedRay> rayQueue, nextRayQueue;
+  std::vector<QueuedShadow> shadowQueue;
+  std::vector<HitInfo> hitQueue;           // rayQueue hits (null if miss)
+  std::vector<uint32_t> queueKeys;        // queue sort keys
+  std::vector<int> queueOrder, keyCounts; // sorted queue indices
+  std::vector<Color> tileColors;
+  Color pathWeight;  // weight of ray being shaded
+  int pathPixel = 0, pathSample = 0;
+  bool shadowPending = false;  // set by queueShadow()
+  bool wavefront = false;
+
+  void queueRay(const Ray& r, const Color& weight) {
+    nextRayQueue.push_back({r, r.diff ? *r.diff : RayDifferentials{},
+                            pathWeight * weight, pathPixel, pathSample});
+  }
+    // queue secondary ray to be traced after current queue
+
+  void queueShadow(const Ray& r, const ShadowGrid* grid, int light) {
+    shadowQueue.push_back({r.base, r.dir, r.min_length, r.max_length, {},
+                           grid, light, pathPixel});
+    shadowPending = true;
+  }
+    // queue shadow ray for a light at the current shading point
+    // (shader sets the light result with setShadowValue())
+
+  void setShadowValue(const Color& value) {
+    shadowQueue.back().value = pathWeight * value; }
+
+  // primary ray objects for current render region
+  // (scene bound list culled by region frustum - objects are owned by scene)
+  std::vector<const Object*> primaryObjects;
+
+  // denoise guide surface values
+  // (captureSurface is set by Renderer before shading a primary ray, the
+  //  first shader that can split its result stores its diffuse color &
+  //  specular/reflection part then clears it)
+  Color albedo, specular;
+  bool captureSurface = false;
 
   // random state
-  std::mt19937_64 rnd;
-  JitterDistribution jitterXDist;
-  JitterDistribution jitterYDist;
-  DiskDistribution apertureDist;
-  UnitDirDistribution dirDist;
+  PCG32 rnd;
+  Sampler sampler;
+  Vec2 jitterScale;
+  uint64_t passSeed = 0;
+  uint64_t pixelSeed = 0;
+  int nextStream = 0;
 
   // helper functions
   void init(const Scene& s);
 
-  [[nodiscard]] Flt rndJitterX() {
-    return jitterXDist(rnd); }
-  [[nodiscard]] Flt rndJitterY() {
-    return jitterYDist(rnd); }
-  [[nodiscard]] Vec2 rndAperturePt() {
-    return apertureDist(rnd); }
-  [[nodiscard]] Vec3 rndDir() {
-    return dirDist(rnd); }
-  [[nodiscard]] Vec3 rndHemisphereDir(const Vec3& normal) {
-    return dirDist(rnd, normal); }
+  void startPixel(int x, int y) {
+    pixelSeed = hashCombine(hashCombine(passSeed, uint64_t(x)), uint64_t(y));
+    sampler.setPixelSeed(pixelSeed);
+    rnd.seed(pixelSeed);
+    nextStream = 0;
+  }
+    // resets per-pixel sample sequence state
+    // (random values only depend on pixel, sample index & scene seed so
+    //  output is the same regardless of job count or task order)
+
+  void startSample(int index) {
+    rnd.seed(hashCombine(pixelSeed, uint64_t(index)));
+  }
+
+  void startQueuedSample(int x, int y, int index) {
+    startPixel(x, y);
+    startSample(index);
+    nextStream = index << 8;
+  }
+    // resets sample state for shading a queued ray
+    // (index is unique for each pixel sample & ray depth so queued rays
+    //  shaded in any order get their own random streams)
+
+  [[nodiscard]] Vec2 rndJitterPt(int index, int count, int cell) {
+    const Vec2 u = sampler(rnd, DIM_JITTER, index, count, cell);
+    return {(u.x - .5) * jitterScale.x, (u.y - .5) * jitterScale.y};
+  }
+    // sub-pixel jitter offset for sample 'index' of 'count' samples in
+    // sub-pixel grid 'cell'
+
+  [[nodiscard]] Vec2 rndAperturePt(int index, int count) {
+    return concentricDisk(sampler(rnd, DIM_APERTURE, index, count, 0)) * .5;
+  }
+    // aperture point in disk of radius .5
+
+  [[nodiscard]] Vec2 rndLightPt(int index, int count, int stream) {
+    return concentricDisk(sampler(rnd, DIM_LIGHT, index, count, stream));
+  }
+    // point in unit disk for area light sampling
+
+  [[nodiscard]] int newStream() { return nextStream++; }
+    // new sample set id for multiple sample calls at a single shading point
+
+  [[nodiscard]] Vec3 rndCosineDir(
+    const Vec3& normal, int index, int count, int stream) {
+    return cosineHemisphere(
+      sampler(rnd, DIM_HEMISPHERE, index, count, stream), normal);
+  }
+    // cosine weighted hemisphere direction around normal
 };
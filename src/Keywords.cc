@@ -9,8 +9,10 @@
 #include "Scene.hh"
 #include "Object.hh"
 #include "Light.hh"
+#include "BasicLights.hh"
 #include "Shader.hh"
 #include "Phong.hh"
+#include "Occlusion.hh"
 #include "BBox.hh"
 #include "Print.hh"
 #include <map>
@@ -275,6 +277,13 @@ static int CoiFn(
   return 0;
 }
 
+static int DenoiseFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getInt(n, s.denoise) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
 static int EyeFn(
   SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
 {
@@ -282,6 +291,24 @@ static int EyeFn(
   return 0;
 }
 
+static int FilterFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  const AstNode* valNode = n;
+  std::string name;
+  if (p || sp.getString(n, name)) { return -1; }
+
+  if (!findFilterType(name, s.filter)) {
+    sp.reportError(valNode, "Unknown filter '", name, "'");
+    return -1;
+  }
+
+  // optional radius
+  s.filter_radius = 0;
+  if (n && sp.getFlt(n, s.filter_radius)) { return -1; }
+  return notDone(sp, n) ? -1 : 0;
+}
+
 static int FocusFn(
   SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
 {
@@ -310,6 +337,13 @@ static int MaxdepthFn(
   return 0;
 }
 
+static int LightSamplesFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getInt(n, s.light_samples) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
 static int MinValueFn(
   SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
 {
@@ -317,6 +351,13 @@ static int MinValueFn(
   return 0;
 }
 
+static int RouletteDepthFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getInt(n, s.roulette_depth) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
 static int RegionFn(
   SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
 {
@@ -342,10 +383,43 @@ static int SamplesFn(
   }
 }
 
+static int SamplerFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  const AstNode* valNode = n;
+  std::string name;
+  if (p || sp.getString(n, name) || notDone(sp, n)) { return -1; }
+
+  if (!findSamplerType(name, s.sampler)) {
+    sp.reportError(valNode, "Unknown sampler '", name, "'");
+    return -1;
+  }
+  return 0;
+}
+
+static int MsaaFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getBool(n, s.msaa) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
+static int WavefrontFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getBool(n, s.wavefront) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
 static int ShadowBoolFn(
   SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
 {
-  if (p || sp.getBool(n, s.shadow) || notDone(sp, n)) { return -1; }
+  // scene shadow setting or object shadow casting
+  bool val;
+  if (sp.getBool(n, val) || notDone(sp, n)) { return -1; }
+  if (p) { return p->setVisible(VIS_SHADOW, val); }
+
+  s.shadow = val;
   return 0;
 }
 
@@ -362,6 +436,13 @@ static int SizeFn(
   return 0;
 }
 
+static int SplitBudgetFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getFlt(n, s.split_budget) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
 static int SuperSampleFn(
   SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
 {
@@ -370,6 +451,27 @@ static int SuperSampleFn(
   return 0;
 }
 
+static int SeedFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getInt(n, s.seed) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
+static int TextureFilterFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getBool(n, s.texture_filter) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
+static int TileSizeFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (p || sp.getInt(n, s.tile_size) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
 static int VupFn(
   SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
 {
@@ -406,6 +508,49 @@ static int DirectionFn(
   return 0;
 }
 
+static int RangeFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  // only lights with a position (& transform) have a distance to limit
+  Light* lt = dynamic_cast<Light*>(p);
+  if (!lt || !lt->trans() || sp.getFlt(n, lt->range) || notDone(sp, n)) {
+    return -1;
+  }
+  return 0;
+}
+
+static int InnerFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  SpotLight* lt = dynamic_cast<SpotLight*>(p);
+  if (!lt || sp.getFlt(n, lt->inner) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
+static int OuterFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  SpotLight* lt = dynamic_cast<SpotLight*>(p);
+  if (!lt || sp.getFlt(n, lt->outer) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
+static int FalloffFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  SpotLight* lt = dynamic_cast<SpotLight*>(p);
+  if (!lt || sp.getFlt(n, lt->falloff) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
+static int CacheFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  Occlusion* sh = dynamic_cast<Occlusion*>(p);
+  if (!sh || sp.getFlt(n, sh->cache) || notDone(sp, n)) { return -1; }
+  return 0;
+}
+
 static int ExpFn(
   SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
 {
@@ -493,6 +638,17 @@ static int ValueFn(
   return p->setValue(val);
 }
 
+template<RayVisibility vis>
+static int VisibleFn(
+  SceneParser& sp, Scene& s, SceneItem* p, AstNode* n, SceneItemFlag flag)
+{
+  if (!p) { return -1; }
+
+  bool val;
+  if (sp.getBool(n, val) || notDone(sp, n)) { return -1; }
+  return p->setVisible(vis, val);
+}
+
 
 // **** Data ****
 using KeywordMap = std::map<std::string,ItemFn,std::less<>>;
@@ -505,15 +661,22 @@ static void initKeywords()
     // keyword      ItemFn
     {"aperture",    ApertureFn},
     {"borderwidth", BorderwidthFn},
+    {"cache",       CacheFn},
+    {"camera",      VisibleFn<VIS_CAMERA>},
     {"coi",         CoiFn},
     {"cost",        CostFn},
+    {"denoise",     DenoiseFn},
     {"dir",         DirectionFn},
     {"direction",   DirectionFn},
     {"exp",         ExpFn},
     {"eye",         EyeFn},
+    {"falloff",     FalloffFn},
+    {"filter",      FilterFn},
     {"focus",       FocusFn},
     {"fov",         FovFn},
+    {"inner",       InnerFn},
     {"jitter",      JitterFn},
+    {"lightsamples", LightSamplesFn},
     {"maxdepth",    MaxdepthFn},
     {"minvalue",    MinValueFn},
     {"move",        MoveFn},
@@ -524,14 +687,20 @@ static void initKeywords()
     {"move_xtop",   MoveByBBoxSpotFn<BBox::XTOP>},
     {"move_ytop",   MoveByBBoxSpotFn<BBox::YTOP>},
     {"move_ztop",   MoveByBBoxSpotFn<BBox::ZTOP>},
+    {"msaa",        MsaaFn},
     {"no_parent",   NoParentFn},
     {"offset",      OffsetFn},
+    {"outer",       OuterFn},
     {"radius",      RadiusFn},
+    {"range",       RangeFn},
+    {"reflect",     VisibleFn<VIS_REFLECT>},
     {"region",      RegionFn},
     {"rgb",         RgbFn},
     {"rotate_x",    RotateByAxisFn<Matrix::XAXIS>},
     {"rotate_y",    RotateByAxisFn<Matrix::YAXIS>},
     {"rotate_z",    RotateByAxisFn<Matrix::ZAXIS>},
+    {"rrdepth",     RouletteDepthFn},
+    {"sampler",     SamplerFn},
     {"samples",     SamplesFn},
     {"scale",       ScaleFn},
     {"scale_x",     ScaleAxisFn<Matrix::XAXIS>},
@@ -542,16 +711,21 @@ static void initKeywords()
     {"scale_yz",    Scale2AxesFn<Matrix::YAXIS, Matrix::ZAXIS>},
     {"scale_xyz",   ScaleAllAxesFn},
     {"sectors",     SectorsFn},
+    {"seed",        SeedFn},
     {"shadow",      ShadowBoolFn},
     {"sides",       SidesFn},
     {"supersample", SuperSampleFn},
     {"size",        SizeFn},
     {"spin",        SpinFn},
+    {"splitbudget", SplitBudgetFn},
     {"stretch_x",   StretchXFn},
     {"stretch_y",   StretchYFn},
     {"stretch_z",   StretchZFn},
+    {"texturefilter", TextureFilterFn},
+    {"tilesize",    TileSizeFn},
     {"value",       ValueFn},
-    {"vup",         VupFn}
+    {"vup",         VupFn},
+    {"wavefront",   WavefrontFn}
   };
 }
 
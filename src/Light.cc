@@ -4,6 +4,9 @@
 //
 
 #include "Light.hh"
+#include "Shader.hh"
+#include "Ray.hh"
+#include <algorithm>
 #include <cassert>
 
 
@@ -16,3 +19,12 @@ int Light::addShader(const ShaderPtr& sh, SceneItemFlag flag)
   _energy = sh;
   return 0;
 }
+
+void Light::initPower(JobState& js, const Scene& s)
+{
+  // energy shader sampled at origin as a power estimate
+  const Ray r{.base = {0,0,0}, .dir = {0,0,1}};
+  const EvaluatedHit eh{
+    .global_pt = {0,0,0}, .normal = {0,0,1}, .map = {0,0,0}, .side = 0};
+  _power = std::max(Flt(_energy->evaluate(js, s, r, eh).grayValue()), 0.0);
+}
@@ -9,10 +9,13 @@
 #include "SceneItem.hh"
 #include "Transform.hh"
 #include "Color.hh"
+#include "MathUtil.hh"
 #include "Types.hh"
 
 
 // **** Types ****
+class BBox;
+
 struct LightResult {
   Vec3 dir{INIT_NONE};
   Flt distance;
@@ -25,6 +28,7 @@ class Light : public SceneItem
 {
  public:
   Vec3 dir{0,0,1};
+  Flt range = 0;  // max distance of light effect (0 for unlimited)
 
   // SceneItem Functions
   int addShader(const ShaderPtr& sh, SceneItemFlag flag) final;
@@ -34,8 +38,35 @@ class Light : public SceneItem
   virtual bool luminate(JobState& js, const Scene& s, const Ray& r,
                         const EvaluatedHit& eh, LightResult& result) const = 0;
 
+  [[nodiscard]] virtual bool bound(BBox& box) const { return false; }
+    // sets box to region light can affect
+    // (returns false if light can affect any point)
+
+  [[nodiscard]] virtual Flt sampleWeight(
+    const Vec3& pt, const Vec3& normal) const { return _power; }
+    // estimated unshadowed contribution at pt for light sampling
+    // (must be positive wherever luminate() can return true)
+
+  void initPower(JobState& js, const Scene& s);
+
+  virtual void initShadows(const Scene& s) { }
+    // build any light specific shadow data (after scene objects are setup)
+
   [[nodiscard]] const ShaderPtr& energy() const { return _energy; }
 
+  [[nodiscard]] int index() const { return _index; }
+  void setIndex(int i) { _index = i; }
+    // position in scene light list (used for per-light job data)
+
  protected:
   ShaderPtr _energy;
+  Flt _power = 1.0;  // estimated energy brightness
+  int _index = -1;
+
+  [[nodiscard]] Flt attenuation(Flt distance) const {
+    // smooth window falloff to zero at range
+    if (!isPositive(range)) { return 1.0; }
+    const Flt x = sqr(sqr(distance / range));
+    return (x < 1.0) ? sqr(1.0 - x) : 0.0;
+  }
 };
@@ -0,0 +1,115 @@
+//
+// LightIndex.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "LightIndex.hh"
+#include "Light.hh"
+#include <algorithm>
+
+
+// **** Helper Functions ****
+[[nodiscard]] static bool contains(const BBox& b, const Vec3& pt)
+{
+  return (pt.x >= b.pmin.x) && (pt.x <= b.pmax.x)
+    && (pt.y >= b.pmin.y) && (pt.y <= b.pmax.y)
+    && (pt.z >= b.pmin.z) && (pt.z <= b.pmax.z);
+}
+
+
+// **** LightIndex Class ****
+void LightIndex::clear()
+{
+  _nodes.clear();
+  _bounded.clear();
+  _unbounded.clear();
+}
+
+void LightIndex::build(std::span<const LightPtr> lights)
+{
+  clear();
+
+  std::vector<BuildItem> items;
+  for (auto& lt : lights) {
+    BBox box;
+    if (lt->bound(box)) {
+      items.push_back({box, box.center(), lt.get()});
+    } else {
+      _unbounded.push_back(lt.get());
+    }
+  }
+
+  if (!items.empty()) {
+    _nodes.reserve((items.size() * 2) - 1);
+    _bounded.reserve(items.size());
+    buildNode(items, 0, int(items.size()));
+  }
+}
+
+int LightIndex::buildNode(std::vector<BuildItem>& items, int start, int end)
+{
+  constexpr int MAX_LEAF_SIZE = 4;
+
+  const int index = int(_nodes.size());
+  _nodes.emplace_back();
+
+  BBox box, centers;
+  for (int i = start; i < end; ++i) {
+    box.fit(items[std::size_t(i)].box);
+    centers.fit(items[std::size_t(i)].center);
+  }
+  _nodes[std::size_t(index)].box = box;
+
+  if ((end - start) <= MAX_LEAF_SIZE) {
+    Node& n = _nodes[std::size_t(index)];
+    n.start = int(_bounded.size());
+    n.count = end - start;
+    for (int i = start; i < end; ++i) {
+      _bounded.push_back(items[std::size_t(i)].lt);
+    }
+    return index;
+  }
+
+  // median split on longest axis of light centers
+  Vec3::size_type axis = 0;
+  if (centers.ylength() > centers.xlength()) { axis = 1; }
+  if (centers.zlength() > std::max(centers.xlength(), centers.ylength())) {
+    axis = 2;
+  }
+
+  const int mid = (start + end) / 2;
+  std::nth_element(items.begin() + start, items.begin() + mid,
+                   items.begin() + end,
+                   [axis](const BuildItem& a, const BuildItem& b) {
+                     return a.center[axis] < b.center[axis]; });
+
+  buildNode(items, start, mid);
+  const int right = buildNode(items, mid, end);
+  _nodes[std::size_t(index)].right = right;
+  return index;
+}
+
+void LightIndex::query(
+  const Vec3& pt, std::vector<const Light*>& results) const
+{
+  results.insert(results.end(), _unbounded.begin(), _unbounded.end());
+  if (_nodes.empty()) { return; }
+
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const int index = stack[--top];
+    const Node& n = _nodes[std::size_t(index)];
+    if (!contains(n.box, pt)) { continue; }
+
+    if (n.count > 0) {
+      for (int i = n.start; i < (n.start + n.count); ++i) {
+        results.push_back(_bounded[std::size_t(i)]);
+      }
+    } else {
+      stack[top++] = n.right;
+      stack[top++] = index + 1;
+    }
+  }
+}
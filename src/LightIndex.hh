@@ -0,0 +1,45 @@
+//
+// LightIndex.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// spatial index (BVH) of lights with limited range for finding the lights
+// that can affect a shading point
+//
+
+#pragma once
+#include "LightPtr.hh"
+#include "BBox.hh"
+#include "Types.hh"
+#include <vector>
+#include <span>
+
+
+// **** Types ****
+class LightIndex
+{
+ public:
+  // Member Functions
+  void clear();
+  void build(std::span<const LightPtr> lights);
+
+  void query(const Vec3& pt, std::vector<const Light*>& results) const;
+    // appends lights that can affect pt
+    // (unbounded lights first in scene order, then bounded lights)
+
+  [[nodiscard]] int boundedCount() const { return int(_bounded.size()); }
+  [[nodiscard]] int nodeCount() const { return int(_nodes.size()); }
+
+ private:
+  struct Node {
+    BBox box;
+    int start = 0, count = 0;  // light range for leaf nodes
+    int right = 0;             // right child index (left is next node)
+  };
+
+  std::vector<Node> _nodes;
+  std::vector<const Light*> _bounded;
+  std::vector<const Light*> _unbounded;
+
+  struct BuildItem { BBox box; Vec3 center; const Light* lt; };
+  int buildNode(std::vector<BuildItem>& items, int start, int end);
+};
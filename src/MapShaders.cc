@@ -10,6 +10,32 @@
 #include <cassert>
 
 
+namespace {
+  template<class MapFn>
+  [[nodiscard]] Vec3 mapDifferential(
+    const MapFn& fn, const Vec3& m, const Vec3& dm, const Vec3& result)
+  {
+    // smaller of forward & backward difference is used so footprint of
+    // a hit next to a map seam doesn't span the whole map
+    const Vec3 fwd = fn(m + dm) - result;
+    const Vec3 bwd = result - fn(m - dm);
+    return (dotProduct(fwd, fwd) < dotProduct(bwd, bwd)) ? fwd : bwd;
+  }
+
+  template<class MapFn>
+  [[nodiscard]] EvaluatedHit mapHit(const EvaluatedHit& eh, const MapFn& fn)
+  {
+    EvaluatedHit eh2 = eh;
+    eh2.map = fn(eh.map);
+    if (eh.differentials) {
+      eh2.dmapdx = mapDifferential(fn, eh.map, eh.dmapdx, eh2.map);
+      eh2.dmapdy = mapDifferential(fn, eh.map, eh.dmapdy, eh2.map);
+    }
+    return eh2;
+  }
+}
+
+
 // **** MapShader Class ****
 int MapShader::addShader(const ShaderPtr& sh, SceneItemFlag flag)
 {
@@ -32,7 +58,10 @@ REGISTER_SHADER_CLASS(MapGlobalShader,"map_global");
 Color MapGlobalShader::evaluate(
   JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh) const
 {
-  EvaluatedHit eh2{eh.global_pt, eh.normal, eh.global_pt, eh.side};
+  EvaluatedHit eh2 = eh;
+  eh2.map = eh.global_pt;
+  eh2.dmapdx = eh.dPdx;
+  eh2.dmapdy = eh.dPdy;
   return _child->evaluate(js, s, r, eh2);
 }
 
@@ -43,22 +72,20 @@ REGISTER_SHADER_CLASS(MapConeShader,"map_cone");
 Color MapConeShader::evaluate(
   JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh) const
 {
-  EvaluatedHit eh2;
-  eh2.global_pt = eh.global_pt;
-  eh2.normal = eh.normal;
-  if (eh.side == 1) {
-    // base
-    eh2.map = {-(eh.map.x), eh.map.y, -1.0};
-  } else {
+  const auto fn = [side=eh.side](const Vec3& m) -> Vec3 {
+    if (side == 1) {
+      // base
+      return {-m.x, m.y, -1.0};
+    }
+
     // side
-    const Vec2 dir = unitVec(eh.map.x, eh.map.y);
+    const Vec2 dir = unitVec(m.x, m.y);
     const Flt x = std::clamp(dir.x, -1.0 + VERY_SMALL, 1.0 - VERY_SMALL);
     const Flt u = (std::acos(x) * (2.0/PI)) - 1.0;
-    eh2.map = {(eh.map.y >= 0.0) ? u : -u, eh.map.z, 0.0};
-  }
-  eh2.side = eh.side;
+    return {(m.y >= 0.0) ? u : -u, m.z, 0.0};
+  };
 
-  return _child->evaluate(js, s, r, eh2);
+  return _child->evaluate(js, s, r, mapHit(eh, fn));
 }
 
 // **** MapCubeShader Class ****
@@ -67,21 +94,19 @@ REGISTER_SHADER_CLASS(MapCubeShader,"map_cube");
 Color MapCubeShader::evaluate(
   JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh) const
 {
-  EvaluatedHit eh2;
-  eh2.global_pt = eh.global_pt;
-  eh2.normal = eh.normal;
-  switch (eh.side) {
-    case 0:  eh2.map = {-eh.map.z,  eh.map.y, 0.0}; break;
-    case 1:  eh2.map = { eh.map.z,  eh.map.y, 0.0}; break;
-    case 2:  eh2.map = { eh.map.x, -eh.map.z, 0.0}; break;
-    case 3:  eh2.map = { eh.map.x,  eh.map.z, 0.0}; break;
-    case 4:  eh2.map = { eh.map.x,  eh.map.y, 0.0}; break;
-    case 5:  eh2.map = {-eh.map.x,  eh.map.y, 0.0}; break;
-    default: eh2.map = eh.map; break;
-  }
-  eh2.side = eh.side;
+  const auto fn = [side=eh.side](const Vec3& m) -> Vec3 {
+    switch (side) {
+      case 0:  return {-m.z,  m.y, 0.0};
+      case 1:  return { m.z,  m.y, 0.0};
+      case 2:  return { m.x, -m.z, 0.0};
+      case 3:  return { m.x,  m.z, 0.0};
+      case 4:  return { m.x,  m.y, 0.0};
+      case 5:  return {-m.x,  m.y, 0.0};
+      default: return m;
+    }
+  };
 
-  return _child->evaluate(js, s, r, eh2);
+  return _child->evaluate(js, s, r, mapHit(eh, fn));
 }
 
 // **** MapCylinderShader Class ****
@@ -90,22 +115,19 @@ REGISTER_SHADER_CLASS(MapCylinderShader,"map_cylinder");
 Color MapCylinderShader::evaluate(
   JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh) const
 {
-  EvaluatedHit eh2;
-  eh2.global_pt = eh.global_pt;
-  eh2.normal = eh.normal;
-  if (eh.side == 0) {
+  const auto fn = [side=eh.side](const Vec3& m) -> Vec3 {
+    if (side != 0) {
+      // end cap hit
+      return m;
+    }
+
     // side hit
-    const Flt x =
-      std::clamp(eh.map.x, -1.0 + VERY_SMALL, 1.0 - VERY_SMALL);
+    const Flt x = std::clamp(m.x, -1.0 + VERY_SMALL, 1.0 - VERY_SMALL);
     const Flt u = (std::acos(x) * (2.0/PI)) - 1.0;
-    eh2.map = {(eh.map.y >= 0.0) ? u : -u, eh.map.z, 0.0};
-  } else {
-    // end cap hit
-    eh2.map = eh.map;
-  }
-  eh2.side = eh.side;
+    return {(m.y >= 0.0) ? u : -u, m.z, 0.0};
+  };
 
-  return _child->evaluate(js, s, r, eh2);
+  return _child->evaluate(js, s, r, mapHit(eh, fn));
 }
 
 // **** MapParaboloidShader Class ****
@@ -114,12 +136,9 @@ REGISTER_SHADER_CLASS(MapParaboloidShader,"map_paraboloid");
 Color MapParaboloidShader::evaluate(
   JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh) const
 {
-  EvaluatedHit eh2{
-    eh.global_pt, eh.normal,
-    {(eh.map.z > 0.0) ? eh.map.x : -eh.map.x, eh.map.y, 0.0},
-    eh.side
-  };
-  return _child->evaluate(js, s, r, eh2);
+  const auto fn = [](const Vec3& m) -> Vec3 {
+    return {(m.z > 0.0) ? m.x : -m.x, m.y, 0.0}; };
+  return _child->evaluate(js, s, r, mapHit(eh, fn));
 }
 
 // **** MapSphereShader Class ****
@@ -128,12 +147,9 @@ REGISTER_SHADER_CLASS(MapSphereShader,"map_sphere");
 Color MapSphereShader::evaluate(
   JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh) const
 {
-  EvaluatedHit eh2{
-    eh.global_pt, eh.normal,
-    {(eh.map.z > 0.0) ? eh.map.x : -eh.map.x, eh.map.y, 0.0},
-    eh.side
-  };
-  return _child->evaluate(js, s, r, eh2);
+  const auto fn = [](const Vec3& m) -> Vec3 {
+    return {(m.z > 0.0) ? m.x : -m.x, m.y, 0.0}; };
+  return _child->evaluate(js, s, r, mapHit(eh, fn));
 }
 
 // **** MapTorusShader Class ****
@@ -142,10 +158,7 @@ REGISTER_SHADER_CLASS(MapTorusShader,"map_torus");
 Color MapTorusShader::evaluate(
   JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh) const
 {
-  EvaluatedHit eh2{
-    eh.global_pt, eh.normal,
-    {(eh.map.y >= 0.0) ? eh.map.x : -eh.map.x, -eh.map.z, 0.0},
-    eh.side
-  };
-  return _child->evaluate(js, s, r, eh2);
+  const auto fn = [](const Vec3& m) -> Vec3 {
+    return {(m.y >= 0.0) ? m.x : -m.x, -m.z, 0.0}; };
+  return _child->evaluate(js, s, r, mapHit(eh, fn));
 }
@@ -6,6 +6,8 @@
 #include "NoiseShaders.hh"
 #include "PerlinNoise.hh"
 #include "RegisterShader.hh"
+#include <algorithm>
+#include <cmath>
 #include <cassert>
 
 
@@ -31,6 +33,25 @@ Color NoiseShader::evaluate(JobState& js, const Scene& s, const Ray& r,
 {
   const Vec3 m = _trans.pointLocalToGlobal(eh.map);
   EvaluatedHit eh2 = eh;
-  eh2.map.x += perlin::noise<Flt>(m.x, m.y, m.z) * _value;
+  if (!eh.differentials) {
+    eh2.map.x += perlin::noise<Flt>(m.x, m.y, m.z) * _value;
+    return _child->evaluate(js, s, r, eh2);
+  }
+
+  // noise is faded out as footprint approaches noise feature size
+  // (noise that can't be resolved averages to zero instead of aliasing)
+  const Vec3 dx = _trans.vectorLocalToGlobal(eh.dmapdx);
+  const Vec3 dy = _trans.vectorLocalToGlobal(eh.dmapdy);
+  const Flt w = std::sqrt(std::max(dotProduct(dx, dx), dotProduct(dy, dy)));
+  const Flt scale = _value * std::clamp(2.0 - (w * 2.0), 0.0, 1.0);
+  if (isPositive(Abs(scale))) {
+    const Flt n = perlin::noise<Flt>(m.x, m.y, m.z);
+    eh2.map.x += n * scale;
+
+    // noise change in footprint for filtered child patterns
+    const Vec3 mx = m + dx, my = m + dy;
+    eh2.dmapdx.x += (perlin::noise<Flt>(mx.x, mx.y, mx.z) - n) * scale;
+    eh2.dmapdy.x += (perlin::noise<Flt>(my.x, my.y, my.z) - n) * scale;
+  }
   return _child->evaluate(js, s, r, eh2);
 }
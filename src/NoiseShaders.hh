@@ -26,6 +26,7 @@ class NoiseShader final : public Shader
   int init(Scene& s, const Transform* tr) override;
   Color evaluate(JobState& js, const Scene& s, const Ray& r,
                  const EvaluatedHit& eh) const override;
+  [[nodiscard]] bool usesFootprint() const override { return true; }
 
  protected:
   Transform _trans;
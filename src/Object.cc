@@ -5,6 +5,8 @@
 
 #include "Object.hh"
 #include "BBox.hh"
+#include "Intersect.hh"
+#include <algorithm>
 #include <cassert>
 
 
@@ -18,12 +20,51 @@ int Object::addShader(const ShaderPtr& sh, SceneItemFlag flag)
   return 0;
 }
 
+bool Object::occludes(const Ray& r, HitList& hl) const
+{
+  intersect(r, hl);
+  return !hl.empty();
+}
+
+BBox Object::clippedBound(unsigned int axis, Flt lo, Flt hi) const
+{
+  BBox b = bound(nullptr);
+  b.pmin[axis] = std::max(b.pmin[axis], lo);
+  b.pmax[axis] = std::min(b.pmax[axis], hi);
+  return b;
+}
+
 
 // **** Primitive Class ****
 BBox Primitive::bound(const Matrix* t) const
 {
-  static constexpr Vec3 pt[8] = {
-    { 1, 1, 1}, {-1, 1, 1}, { 1,-1, 1}, { 1, 1,-1},
-    {-1,-1, 1}, { 1,-1,-1}, {-1, 1,-1}, {-1,-1,-1}};
-  return {std::data(pt), std::size(pt), t ? *t : _trans.final()};
+  return {std::data(CUBE_BOUND_POINTS), std::size(CUBE_BOUND_POINTS),
+          t ? *t : _trans.final()};
+}
+
+BBox Primitive::clipBoundPoints(
+  std::span<const Vec3> pts, unsigned int axis, Flt lo, Flt hi) const
+{
+  // hull points inside range & crossings of range limits by line segments
+  // between hull points
+  assert(pts.size() <= 8);
+  Vec3 p[8];
+  BBox b;
+  for (std::size_t i = 0; i < pts.size(); ++i) {
+    p[i] = multPoint(pts[i], _trans.final());
+    if (p[i][axis] >= lo && p[i][axis] <= hi) { b.fit(p[i]); }
+  }
+
+  for (std::size_t i = 0; i < pts.size(); ++i) {
+    for (std::size_t j = i + 1; j < pts.size(); ++j) {
+      const Flt vi = p[i][axis], vj = p[j][axis];
+      for (const Flt v : {lo, hi}) {
+        if ((vi < v && vj > v) || (vi > v && vj < v)) {
+          b.fit(p[i] + ((p[j] - p[i]) * ((v - vi) / (vj - vi))));
+        }
+      }
+    }
+  }
+
+  return b;
 }
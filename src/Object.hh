@@ -21,17 +21,28 @@ class Object : public SceneItem
  public:
   // SceneItem Functions
   int addShader(const ShaderPtr& sh, SceneItemFlag flag) final;
+  int setVisible(RayVisibility v, bool val) final {
+    _visibility = val ? (_visibility | v) : (_visibility & ~unsigned(v));
+    return 0; }
 
   // Member Functions
   virtual int init(Scene& s, const Transform* tr) { return 0; }
   virtual BBox bound(const Matrix* t = nullptr) const = 0;
   virtual int intersect(const Ray& r, HitList& hl) const = 0;
+  virtual bool occludes(const Ray& r, HitList& hl) const;
+    // any hit test for shadow rays (can stop at first hit found)
   virtual std::span<const ObjectPtr> children() const { return {}; }
+  virtual BBox clippedBound(unsigned int axis, Flt lo, Flt hi) const;
+    // bound of object part between lo & hi on axis (for spatial splits)
 
   [[nodiscard]] const ShaderPtr& shader() const { return _shader; }
+  [[nodiscard]] unsigned visibility() const { return _visibility; }
+    // RayVisibility flags (group flags apply to all group members,
+    // flags of CSG members are ignored)
 
  protected:
   ShaderPtr _shader;
+  unsigned _visibility = VIS_ALL;
 };
 
 
@@ -51,7 +62,18 @@ class Primitive : public Object
   virtual Flt hitCost(const HitCostInfo& hc) const = 0;
   virtual Vec3 normal(const Ray& r, const HitInfo& h) const = 0;
 
+  [[nodiscard]] const Transform& transform() const { return _trans; }
+
  protected:
+  static constexpr Vec3 CUBE_BOUND_POINTS[8] = {
+    { 1, 1, 1}, {-1, 1, 1}, { 1,-1, 1}, { 1, 1,-1},
+    {-1,-1, 1}, { 1,-1,-1}, {-1, 1,-1}, {-1,-1,-1}};
+
   Transform _trans;
   Flt _cost = -1.0; // non-negative to override default cost
+
+  [[nodiscard]] BBox clipBoundPoints(
+    std::span<const Vec3> pts, unsigned int axis, Flt lo, Flt hi) const;
+    // bound of transformed convex hull of pts between lo & hi on axis
+    // (for clippedBound() of objects inside the hull of pts)
 };
@@ -8,12 +8,124 @@
 #include "Scene.hh"
 #include "Ray.hh"
 #include "RegisterShader.hh"
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
 #include <cassert>
 
 
+// **** OcclusionCache Class ****
+// irradiance cache style store of sparse occlusion values shared by all
+// render jobs
+//   records are valid within a radius based on the distance to nearby
+//   geometry and are stored in each grid cell their valid region overlaps
+class OcclusionCache
+{
+ public:
+  OcclusionCache(Flt cellSize, Flt maxError)
+    : _cellInv{1.0 / cellSize}, _maxError{maxError} { }
+
+  [[nodiscard]] bool lookup(const Vec3& pt, const Vec3& normal,
+                            Flt& value) const;
+  void add(const Vec3& pt, const Vec3& normal, Flt value, Flt radius);
+
+ private:
+  struct Record {
+    Vec3 pt, normal;
+    Flt value, radius;
+  };
+
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint64_t,std::vector<Record>> cells;
+  };
+
+  static constexpr int SHARDS = 64;
+  std::array<Shard,SHARDS> _shards;
+  Flt _cellInv;
+  Flt _maxError;
+
+  [[nodiscard]] int64_t cellCoord(Flt v) const {
+    return int64_t(std::floor(v * _cellInv)); }
+
+  [[nodiscard]] static uint64_t cellKey(int64_t x, int64_t y, int64_t z) {
+    constexpr uint64_t mask = (1 << 21) - 1;
+    return (uint64_t(x) & mask) | ((uint64_t(y) & mask) << 21)
+      | ((uint64_t(z) & mask) << 42);
+  }
+
+  [[nodiscard]] Shard& shard(uint64_t key) {
+    return _shards[mixBits(key) % SHARDS]; }
+  [[nodiscard]] const Shard& shard(uint64_t key) const {
+    return _shards[mixBits(key) % SHARDS]; }
+};
+
+bool OcclusionCache::lookup(
+  const Vec3& pt, const Vec3& normal, Flt& value) const
+{
+  const uint64_t key =
+    cellKey(cellCoord(pt.x), cellCoord(pt.y), cellCoord(pt.z));
+  const Shard& sh = shard(key);
+  std::shared_lock lock{sh.mutex};
+
+  const auto itr = sh.cells.find(key);
+  if (itr == sh.cells.end()) { return false; }
+
+  // weighted average of valid records
+  // (error grows with distance & normal difference, record invalid at 1)
+  Flt total = 0, weight = 0;
+  for (const Record& rec : itr->second) {
+    const Vec3 d = pt - rec.pt;
+    const Flt nd = std::max(1.0 - dotProduct(normal, rec.normal), 0.0);
+    const Flt e = (d.length() / rec.radius) + (std::sqrt(nd) * 3.0);
+    if (e >= 1.0) { continue; }
+
+    // reject records in front of point (could be on other side of
+    // a thin object or in a corner)
+    if (dotProduct(d, normal + rec.normal) < -(rec.radius * .05)) {
+      continue; }
+
+    const Flt w = 1.0 - e;
+    total += rec.value * w;
+    weight += w;
+  }
+
+  if (!isPositive(weight)) { return false; }
+  value = total / weight;
+  return true;
+}
+
+void OcclusionCache::add(
+  const Vec3& pt, const Vec3& normal, Flt value, Flt radius)
+{
+  const Record rec{pt, normal, value, radius};
+  const int64_t x0 = cellCoord(pt.x - radius), x1 = cellCoord(pt.x + radius);
+  const int64_t y0 = cellCoord(pt.y - radius), y1 = cellCoord(pt.y + radius);
+  const int64_t z0 = cellCoord(pt.z - radius), z1 = cellCoord(pt.z + radius);
+
+  for (int64_t z = z0; z <= z1; ++z) {
+    for (int64_t y = y0; y <= y1; ++y) {
+      for (int64_t x = x0; x <= x1; ++x) {
+        const uint64_t key = cellKey(x, y, z);
+        Shard& sh = shard(key);
+        std::unique_lock lock{sh.mutex};
+        sh.cells[key].push_back(rec);
+      }
+    }
+  }
+}
+
+
 // **** Occlusion Class ****
 REGISTER_SHADER_CLASS(Occlusion,"occlusion");
 
+Occlusion::Occlusion() = default;
+Occlusion::~Occlusion() = default;
+
 int Occlusion::addShader(const ShaderPtr& sh, SceneItemFlag flag)
 {
   assert(sh != nullptr);
@@ -25,11 +137,18 @@ int Occlusion::addShader(const ShaderPtr& sh, SceneItemFlag flag)
 
 int Occlusion::init(Scene& s, const Transform* tr)
 {
+  _cache.reset();
+  if (isPositive(cache)) {
+    // record valid radius is limited to occlusion radius so cells only
+    // have to be that large
+    _cache = std::make_unique<OcclusionCache>(_radius, cache);
+  }
+
   return _child ? s.initShader(*_child, tr) : -1;
 }
 
-Color Occlusion::evaluate(JobState& js, const Scene& s, const Ray& r,
-                          const EvaluatedHit& eh) const
+Flt Occlusion::sampleOcclusion(JobState& js, const Scene& s,
+                               const EvaluatedHit& eh, Flt* hitRadius) const
 {
   Ray sray {
     .base       = eh.global_pt,
@@ -37,16 +156,60 @@ Color Occlusion::evaluate(JobState& js, const Scene& s, const Ray& r,
     .max_length = _radius
   };
 
+  // stratified, cosine weighted directions
+  const int stream = js.newStream();
   int lit = 0;
+  Flt invDistSum = 0;
   for (int i = 0; i < _samples; ++i) {
-    sray.dir = js.rndHemisphereDir(eh.normal);
-    if (!s.castShadowRay(js, sray)) { ++lit; }
+    sray.dir = js.rndCosineDir(eh.normal, i, _samples, stream);
+    if (hitRadius) {
+      // nearest hit distance needed for record valid radius
+      const Flt d = s.hitDistance(js, sray);
+      if (d < _radius) {
+        invDistSum += 1.0 / std::max(d, s.ray_moveout);
+      } else {
+        invDistSum += 1.0 / _radius;
+        ++lit;
+      }
+    } else if (!s.castShadowRay(js, sray)) {
+      ++lit;
+    }
+  }
+
+  if (hitRadius) {
+    // harmonic mean distance to geometry
+    *hitRadius = Flt(_samples) / invDistSum;
+  }
+
+  return Flt(lit) / Flt(_samples);
+}
+
+Color Occlusion::evaluate(JobState& js, const Scene& s, const Ray& r,
+                          const EvaluatedHit& eh) const
+{
+  Flt value;
+  if (!_cache) {
+    value = sampleOcclusion(js, s, eh, nullptr);
+  } else {
+    ++js.stats.ao_cache.tried;
+    if (_cache->lookup(eh.global_pt, eh.normal, value)) {
+      ++js.stats.ao_cache.hit;
+    } else {
+      Flt hitRadius;
+      value = sampleOcclusion(js, s, eh, &hitRadius);
+      _cache->add(eh.global_pt, eh.normal, value,
+                  std::clamp(hitRadius * cache, _radius * .02, _radius));
+    }
   }
 
-  if (lit == 0) {
+  if (!isPositive(value)) {
     return colors::black;
   }
 
-  return _child->evaluate(js, s, r, eh)
-    * (Color::value_type(lit) / Color::value_type(_samples));
+  // wavefront rays & shadows queued by the child are also scaled
+  const Color pathWeight = js.pathWeight;
+  js.pathWeight = pathWeight * Color::value_type(value);
+  const Color result = _child->evaluate(js, s, r, eh) * value;
+  js.pathWeight = pathWeight;
+  return result;
 }
@@ -7,11 +7,19 @@
 
 #pragma once
 #include "Shader.hh"
+#include <memory>
 
 
+class OcclusionCache;
+
 class Occlusion final : public Shader
 {
  public:
+  Flt cache = 0;  // cache error tolerance (0 disables cache)
+
+  Occlusion();
+  ~Occlusion() override;
+
   // SceneItem Functions
   std::string desc() const override { return "<Occlusion>"; }
   int setRadius(Flt v) override { _radius = v; return 0; }
@@ -27,4 +35,9 @@ class Occlusion final : public Shader
   ShaderPtr _child;
   Flt _radius = .1;
   int _samples = 4;
+  std::unique_ptr<OcclusionCache> _cache;
+
+  [[nodiscard]] Flt sampleOcclusion(JobState& js, const Scene& s,
+                                    const EvaluatedHit& eh,
+                                    Flt* hitRadius) const;
 };
@@ -4,12 +4,96 @@
 //
 
 #include "PatternShaders.hh"
+#include "JobState.hh"
 #include "Print.hh"
 #include "RegisterShader.hh"
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 
 
+namespace {
+  constexpr Flt MIN_FILTER_WIDTH = 1.0e-5;
+    // smaller footprints are point sampled
+  constexpr Flt MAX_FILTER_WIDTH = 64.0;
+    // footprint clamp (in pattern periods)
+
+  [[nodiscard]] Flt filterWidth(Flt dx, Flt dy)
+  {
+    // box footprint width for a pattern value from its x/y differentials
+    return std::max(Abs(dx), Abs(dy));
+  }
+
+  [[nodiscard]] Flt cellsBelow(Flt x, int k, int n)
+  {
+    // total length of cells with index k (mod n) in [0,x)
+    const Flt periods = std::floor(x / Flt(n));
+    return periods + std::clamp(x - (periods * Flt(n)) - Flt(k), 0.0, 1.0);
+  }
+
+  void cellCoverage(Flt x, Flt w, int n, PatternShader::Coverage& cov)
+  {
+    // fraction of footprint [x-w/2,x+w/2] covered by each cell index
+    // (floor(x) mod n)
+    cov.fill(0);
+    w = std::min(w, Flt(n) * MAX_FILTER_WIDTH);
+    const Flt a = x - (w * .5), b = x + (w * .5);
+    const Flt cell = std::floor(a);
+    if (w < MIN_FILTER_WIDTH || cell == std::floor(b)) {
+      // footprint inside a single cell
+      int c = int(std::floor(x)) % n;
+      if (c < 0) { c += n; }
+      cov[std::size_t(c)] = 1.0;
+      return;
+    }
+
+    for (int k = 0; k < n; ++k) {
+      cov[std::size_t(k)] = (cellsBelow(b, k, n) - cellsBelow(a, k, n)) / w;
+    }
+  }
+
+  void addCoverage(
+    PatternShader::Coverage& cov, const PatternShader::Coverage& c2, int n)
+  {
+    // coverage of (cell index a + cell index b) mod n
+    PatternShader::Coverage result{};
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        result[std::size_t((i + j) % n)] +=
+          cov[std::size_t(i)] * c2[std::size_t(j)];
+      }
+    }
+    cov = result;
+  }
+
+  [[nodiscard]] Flt bandCoverage(Flt x, Flt w, Flt bw)
+  {
+    // fraction of footprint covered by border bands centered on integer
+    // values (|x - round(x)| < bw/2)
+    if (bw >= 1.0) { return 1.0; }
+
+    // position relative to start of band
+    const Flt half_bw = bw * .5;
+    w = std::min(w, MAX_FILTER_WIDTH);
+    const Flt a = x + half_bw - (w * .5);
+    const Flt fa = std::floor(a);
+    if (w < MIN_FILTER_WIDTH || (fa == std::floor(a + w))) {
+      // footprint doesn't cross a cell edge
+      const Flt v0 = a - fa;
+      if (v0 >= bw) { return 0.0; }
+      if (w < MIN_FILTER_WIDTH) { return 1.0; }
+      return (std::min(v0 + w, bw) - v0) / w;
+    }
+
+    const auto below = [bw](Flt v) {
+      const Flt f = std::floor(v);
+      return (f * bw) + std::min(v - f, bw);
+    };
+    return (below(a + w) - below(a)) / w;
+  }
+}
+
+
 // **** PatternShader Class ****
 int PatternShader::addShader(const ShaderPtr& sh, SceneItemFlag flag)
 {
@@ -47,6 +131,43 @@ int PatternShader::init(Scene& s, const Transform* tr)
   return 0;
 }
 
+Color PatternShader::blend(
+  JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh,
+  const Coverage& cov, Flt border) const
+{
+  // children with a tiny part of the footprint are skipped
+  constexpr Flt MIN_WEIGHT = .001;
+
+  const Flt inside = 1.0 - border;
+  Flt total = (border > MIN_WEIGHT) ? border : 0.0;
+  for (std::size_t i = 0; i < _children.size(); ++i) {
+    const Flt w = cov[i] * inside;
+    if (w > MIN_WEIGHT) { total += w; }
+  }
+
+  // wavefront rays & shadows queued by a child are scaled by its share
+  // of the result like the color it returns
+  const Color pathWeight = js.pathWeight;
+  Color result{colors::black};
+  if (border > MIN_WEIGHT) {
+    const auto f = Color::value_type(border / total);
+    js.pathWeight = pathWeight * f;
+    result += _border->evaluate(js, s, r, eh) * f;
+  }
+
+  for (std::size_t i = 0; i < _children.size(); ++i) {
+    const Flt w = cov[i] * inside;
+    if (w > MIN_WEIGHT) {
+      const auto f = Color::value_type(w / total);
+      js.pathWeight = pathWeight * f;
+      result += _children[i]->evaluate(js, s, r, eh) * f;
+    }
+  }
+
+  js.pathWeight = pathWeight;
+  return result;
+}
+
 
 // **** Checkerboard Class ****
 REGISTER_SHADER_CLASS(Checkerboard,"checker");
@@ -56,6 +177,27 @@ Color Checkerboard::evaluate(
 {
   const Vec2 m = _trans.pointLocalToGlobalXY(eh.map);
 
+  if (filtered(eh)) {
+    const Vec3 dx = _trans.vectorLocalToGlobal(eh.dmapdx);
+    const Vec3 dy = _trans.vectorLocalToGlobal(eh.dmapdy);
+    const Flt wx = filterWidth(dx.x, dy.x);
+    const Flt wy = filterWidth(dx.y, dy.y);
+
+    Flt border = 0;
+    if (_border) {
+      const Flt bx = bandCoverage(m.x, wx, _borderwidth);
+      const Flt by = bandCoverage(m.y, wy, _borderwidth);
+      border = bx + by - (bx * by);
+    }
+
+    const int no = int(_children.size());
+    Coverage cov, cy;
+    cellCoverage(m.x + VERY_SMALL, wx, no, cov);
+    cellCoverage(m.y + VERY_SMALL, wy, no, cy);
+    addCoverage(cov, cy, no);
+    return blend(js, s, r, eh, cov, border);
+  }
+
   if (_border) {
     const Flt half_bw = _borderwidth * .5;
     if (Abs(m.x - std::floor(m.x + half_bw)) < half_bw
@@ -78,6 +220,30 @@ Color Checkerboard3D::evaluate(
 {
   const Vec3 m = _trans.pointLocalToGlobal(eh.map);
 
+  if (filtered(eh)) {
+    const Vec3 dx = _trans.vectorLocalToGlobal(eh.dmapdx);
+    const Vec3 dy = _trans.vectorLocalToGlobal(eh.dmapdy);
+    const Flt wx = filterWidth(dx.x, dy.x);
+    const Flt wy = filterWidth(dx.y, dy.y);
+    const Flt wz = filterWidth(dx.z, dy.z);
+
+    Flt border = 0;
+    if (_border) {
+      border = 1.0 - ((1.0 - bandCoverage(m.x, wx, _borderwidth))
+                      * (1.0 - bandCoverage(m.y, wy, _borderwidth))
+                      * (1.0 - bandCoverage(m.z, wz, _borderwidth)));
+    }
+
+    const int no = int(_children.size());
+    Coverage cov, c2;
+    cellCoverage(m.x + VERY_SMALL, wx, no, cov);
+    cellCoverage(m.y + VERY_SMALL, wy, no, c2);
+    addCoverage(cov, c2, no);
+    cellCoverage(m.z + VERY_SMALL, wz, no, c2);
+    addCoverage(cov, c2, no);
+    return blend(js, s, r, eh, cov, border);
+  }
+
   if (_border) {
     const Flt half_bw = _borderwidth * .5;
     if (Abs(m.x - std::floor(m.x + half_bw)) < half_bw
@@ -107,6 +273,29 @@ Color Pinwheel::evaluate(
   const Flt angle = std::atan2(m.y, m.x) + spin_val;
 
   const Flt sect = Flt(_sectors) * (angle / (PI * 2.0));
+  if (filtered(eh)) {
+    const Vec3 dx = _trans.vectorLocalToGlobal(eh.dmapdx);
+    const Vec3 dy = _trans.vectorLocalToGlobal(eh.dmapdy);
+    const Flt r2 = std::max(sqr(m.x) + sqr(m.y), VERY_SMALL);
+    const Flt rad = std::sqrt(r2);
+    const Flt sectScale = Flt(_sectors) / (PI * 2.0);
+    const auto dsect = [&](const Vec3& d) {
+      // angle change + spin change from radius change
+      return (((m.x * d.y) - (m.y * d.x)) / r2
+              + (_spin * PI * .25 * ((m.x * d.x) + (m.y * d.y)) / rad))
+        * sectScale;
+    };
+    const Flt w = filterWidth(dsect(dx), dsect(dy));
+
+    // border width in sectors at current radius
+    const Flt border = _border ? bandCoverage(
+      sect, w, std::min(_borderwidth * sectScale / rad, 1.0)) : 0.0;
+
+    Coverage cov;
+    cellCoverage(sect, w, int(_children.size()), cov);
+    return blend(js, s, r, eh, cov, border);
+  }
+
   if (_border) {
     // check distance to nearest edge point at the same radius
     // (works well enough for border calc if the spin isn't too high)
@@ -133,6 +322,20 @@ Color Ring::evaluate(
   const Vec2 m = _trans.pointLocalToGlobalXY(eh.map);
   const Flt d = std::sqrt(sqr(m.x) + sqr(m.y)) + _offset;
 
+  if (filtered(eh)) {
+    const Vec3 dx = _trans.vectorLocalToGlobal(eh.dmapdx);
+    const Vec3 dy = _trans.vectorLocalToGlobal(eh.dmapdy);
+    const Flt rad = std::max(d - _offset, VERY_SMALL);
+    const Flt w = filterWidth(((m.x * dx.x) + (m.y * dx.y)) / rad,
+                              ((m.x * dy.x) + (m.y * dy.y)) / rad);
+    const Flt border = (_border && (d - _offset) > (_borderwidth * .5))
+      ? bandCoverage(d, w, _borderwidth) : 0.0;
+
+    Coverage cov;
+    cellCoverage(d, w, int(_children.size()), cov);
+    return blend(js, s, r, eh, cov, border);
+  }
+
   if (_border) {
     const Flt half_bw = _borderwidth * .5;
     if ((d - _offset) > half_bw
@@ -155,6 +358,19 @@ Color SquareRing::evaluate(
   const Vec2 m = _trans.pointLocalToGlobalXY(eh.map);
   const Flt d = std::max(Abs(m.x), Abs(m.y)) + _offset;
 
+  if (filtered(eh)) {
+    const Vec3 dx = _trans.vectorLocalToGlobal(eh.dmapdx);
+    const Vec3 dy = _trans.vectorLocalToGlobal(eh.dmapdy);
+    const Flt w = (Abs(m.x) > Abs(m.y))
+      ? filterWidth(dx.x, dy.x) : filterWidth(dx.y, dy.y);
+    const Flt border = (_border && (d - _offset) > (_borderwidth * .5))
+      ? bandCoverage(d, w, _borderwidth) : 0.0;
+
+    Coverage cov;
+    cellCoverage(d, w, int(_children.size()), cov);
+    return blend(js, s, r, eh, cov, border);
+  }
+
   if (_border) {
     const Flt half_bw = _borderwidth * .5;
     if ((d - _offset) > half_bw
@@ -176,6 +392,16 @@ Color Stripe::evaluate(
 {
   const Flt d = _trans.pointLocalToGlobalX(eh.map);
 
+  if (filtered(eh)) {
+    const Flt w = filterWidth(_trans.vectorLocalToGlobal(eh.dmapdx).x,
+                              _trans.vectorLocalToGlobal(eh.dmapdy).x);
+    const Flt border = _border ? bandCoverage(d, w, _borderwidth) : 0.0;
+
+    Coverage cov;
+    cellCoverage(d + VERY_SMALL, w, int(_children.size()), cov);
+    return blend(js, s, r, eh, cov, border);
+  }
+
   if (_border) {
     const Flt half_bw = _borderwidth * .5;
     if (Abs(d - std::floor(d + half_bw)) < half_bw) {
@@ -18,11 +18,15 @@
 //
 // all pattern shaders take an optional border shader & borderwidth
 //
+// patterns are box filtered over the hit footprint from ray differentials
+// (children & border are blended by how much of the footprint they cover)
+//
 
 #pragma once
 #include "Shader.hh"
 #include "ShaderPtr.hh"
 #include "Transform.hh"
+#include <array>
 #include <vector>
 
 
@@ -37,6 +41,12 @@ class PatternShader : public Shader
 
   // Shader Functions
   int init(Scene& s, const Transform* tr) final;
+  [[nodiscard]] bool usesFootprint() const final { return true; }
+
+  // Filtering
+  static constexpr int MAX_FILTER_CHILDREN = 8;
+    // patterns with more children are always point sampled
+  using Coverage = std::array<Flt,MAX_FILTER_CHILDREN>;
 
  protected:
   Transform _trans;
@@ -50,6 +60,14 @@ class PatternShader : public Shader
     if (c < 0) { c += no; }
     return _children[std::size_t(c)].get();
   }
+
+  [[nodiscard]] bool filtered(const EvaluatedHit& eh) const {
+    return eh.differentials && int(_children.size()) <= MAX_FILTER_CHILDREN; }
+
+  [[nodiscard]] Color blend(
+    JobState& js, const Scene& s, const Ray& r, const EvaluatedHit& eh,
+    const Coverage& cov, Flt border) const;
+    // evaluates children in proportion to their footprint coverage
 };
 
 
@@ -6,8 +6,11 @@
 #include "Phong.hh"
 #include "Scene.hh"
 #include "Light.hh"
+#include "JobState.hh"
 #include "Ray.hh"
 #include "RegisterShader.hh"
+#include <algorithm>
+#include <utility>
 #include <cassert>
 
 
@@ -68,6 +71,9 @@ Color Phong::evaluate(
 {
   const auto black_val = static_cast<Color::value_type>(s.min_ray_value);
 
+  const bool capture = js.captureSurface && (r.depth == 0);
+  if (capture) { js.captureSurface = false; }
+
   // Evaluate Shaders
   const Color color_d = _diffuse->evaluate(js, s, r, eh);
 
@@ -84,45 +90,134 @@ Color Phong::evaluate(
 
   // ambient calculation
   Color result = _ambient->evaluate(js, s, r, eh) * color_d;
+  Color spec_result{colors::black};
 
   // diffuse/specular lighting calculations
-  for (auto& lt : s.lights()) {
+  const auto addLight = [&](const Light& lt, Flt scale) {
     LightResult lresult;
-    if (!lt->luminate(js, s, r, eh, lresult)) { continue; }
+    const bool lit = lt.luminate(js, s, r, eh, lresult);
+    const bool queued = std::exchange(js.shadowPending, false);
+    if (!lit) {
+      if (queued) { js.shadowQueue.pop_back(); }
+      return;
+    }
+    if (scale != 1.0) { lresult.energy *= scale; }
 
     // diffuse calculation
-    result += (lresult.energy * color_d) * lresult.angle;
+    const Color diffuse = (lresult.energy * color_d) * lresult.angle;
 
+    Color spec{colors::black};
     if (is_s) {
       // specular hi-light calculation
 #if 1
       // phong
       const Flt angle = dotProduct(reflect, lresult.dir);
       if (isPositive(angle)) {
-	result += (lresult.energy * color_s) * std::pow(angle, exp);
+	spec = (lresult.energy * color_s) * std::pow(angle, exp);
       }
 #else
       // blinn-phong
       const Vec3 halfway = UnitVec(lresult.dir - r.dir);
       const Flt angle = dotProduct(halfway, eh.normal);
       if (isPositive(angle)) {
-	result += (lresult.energy * color_s) * std::pow(angle, exp * 4.0);
+	spec = (lresult.energy * color_s) * std::pow(angle, exp * 4.0);
       }
 #endif
     }
+
+    if (queued) {
+      // wavefront render - light is added if shadow ray isn't blocked
+      Color value = diffuse;
+      value += spec;
+      js.setShadowValue(value);
+    } else {
+      result += diffuse;
+      spec_result += spec;
+    }
+  };
+
+  const auto lights = s.lightsAt(js, eh.global_pt);
+  const int samples = s.light_samples;
+  if (samples <= 0 || int(lights.size()) <= samples) {
+    for (const Light* lt : lights) { addLight(*lt, 1.0); }
+  } else {
+    // stochastic light sampling - lights are picked in proportion to their
+    // estimated contribution and weighted by 1/(samples * p) so the result
+    // is unbiased (noise is averaged out by the pixel's samples)
+    auto& cdf = js.lightWeights;
+    cdf.resize(lights.size());
+    Flt total = 0;
+    for (std::size_t i = 0; i < lights.size(); ++i) {
+      total += lights[i]->sampleWeight(eh.global_pt, eh.normal);
+      cdf[i] = total;
+    }
+
+    if (isPositive(total)) {
+      for (int k = 0; k < samples; ++k) {
+        // stratified selection
+        const Flt u = total * (Flt(k) + js.rnd.uniform()) / Flt(samples);
+        const auto i = std::min(
+          std::size_t(std::upper_bound(cdf.begin(), cdf.end(), u)
+                      - cdf.begin()), lights.size() - 1);
+        const Flt p = (cdf[i] - ((i > 0) ? cdf[i-1] : 0.0)) / total;
+        if (isPositive(p)) { addLight(*lights[i], 1.0 / (Flt(samples) * p)); }
+      }
+    }
   }
 
   // reflection calculation
   if (is_s && r.depth < s.max_ray_depth) {
-    Ray ray {
-      .base       = eh.global_pt,
-      .dir        = reflect,
-      .min_length = s.ray_moveout,
-      .depth      = r.depth + 1
-    };
-
-    result += s.traceRay(js, ray) * color_s;
+    Flt weight = r.weight * Flt(color_s.maxValue());
+    Flt scale = 1.0;
+    if (s.roulette_depth > 0 && r.depth >= s.roulette_depth - 1
+        && weight < 1.0) {
+      // russian roulette - survivors are scaled up to keep result unbiased
+      if (js.rnd.uniform() < weight) {
+        scale = 1.0 / weight;
+        weight = 1.0;
+      } else {
+        weight = 0;  // ray terminated
+      }
+    }
+
+    if (isPositive(weight) && weight >= s.min_ray_value) {
+      Ray ray {
+        .base       = eh.global_pt,
+        .dir        = reflect,
+        .min_length = s.ray_moveout,
+        .depth      = r.depth + 1,
+        .weight     = weight
+      };
+
+      RayDifferentials diff;
+      if (eh.differentials) {
+        // reflected ray differentials (Igehy 1999)
+        const Flt dn = dotProduct(r.dir, eh.normal);
+        const auto reflectDiff = [&](const Vec3& dD, const Vec3& dN) {
+          const Flt ddn = dotProduct(dD, eh.normal) + dotProduct(r.dir, dN);
+          return dD - (((dN * dn) + (eh.normal * ddn)) * 2.0);
+        };
+        diff.dPdx = eh.dPdx;
+        diff.dPdy = eh.dPdy;
+        diff.dDdx = reflectDiff(r.diff->dDdx, eh.dNdx);
+        diff.dDdy = reflectDiff(r.diff->dDdy, eh.dNdy);
+        ray.diff = &diff;
+      }
+
+      if (js.wavefront) {
+        js.queueRay(ray, color_s * scale);
+      } else {
+        spec_result += s.traceRay(js, ray) * color_s * scale;
+      }
+    }
+  }
+
+  if (capture) {
+    // diffuse & specular parts for denoise
+    js.albedo = color_d;
+    js.specular = spec_result;
   }
 
+  result += spec_result;
   return result;
 }
@@ -0,0 +1,199 @@
+//
+// QuantizedBounds.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "QuantizedBounds.hh"
+#include "Object.hh"
+#include "Intersect.hh"
+#include "Ray.hh"
+#include "Stats.hh"
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+
+// **** Helper Functions ****
+namespace {
+  constexpr Flt QUANT_MAX = 65535.0;
+
+  [[nodiscard]] inline Vec3 quantScale(const BBox& b)
+  {
+    return (b.pmax - b.pmin) * (1.0 / QUANT_MAX);
+  }
+
+  [[nodiscard]] inline BBox decodeBox(
+    const BBox& parent, const Vec3& scale, const uint16_t (&q)[6])
+  {
+    // max value decodes to the parent face exactly
+    // (pmin + (QUANT_MAX * scale) can round to just inside it)
+    const auto maxVal = [&](uint16_t v, unsigned int i) {
+      return (v == uint16_t(QUANT_MAX))
+        ? parent.pmax[i] : parent.pmin[i] + (Flt(v) * scale[i]); };
+
+    BBox b{INIT_NONE};
+    b.pmin = {parent.pmin.x + (Flt(q[0]) * scale.x),
+              parent.pmin.y + (Flt(q[1]) * scale.y),
+              parent.pmin.z + (Flt(q[2]) * scale.z)};
+    b.pmax = {maxVal(q[3], 0), maxVal(q[4], 1), maxVal(q[5], 2)};
+    return b;
+  }
+
+  [[nodiscard]] inline bool contains(const BBox& outer, const BBox& b)
+  {
+    return b.pmin.x >= outer.pmin.x && b.pmax.x <= outer.pmax.x
+      && b.pmin.y >= outer.pmin.y && b.pmax.y <= outer.pmax.y
+      && b.pmin.z >= outer.pmin.z && b.pmax.z <= outer.pmax.z;
+  }
+}
+
+
+// **** QuantizedBounds Class ****
+uint32_t QuantizedBounds::addNode()
+{
+  _nodes.push_back({{}, {EMPTY_REF, EMPTY_REF}});
+  return uint32_t(_nodes.size() - 1);
+}
+
+uint32_t QuantizedBounds::addLeaf(std::span<const Object* const> objects)
+{
+  assert(!objects.empty() && objects.size() <= MAX_LEAF_SIZE);
+  const auto start = uint32_t(_objects.size());
+  assert(start < (1u << 24));
+  _objects.insert(_objects.end(), objects.begin(), objects.end());
+  return LEAF_FLAG | (uint32_t(objects.size()) << 24) | start;
+}
+
+BBox QuantizedBounds::setChild(uint32_t node, const BBox& nodeBox, int slot,
+                               const BBox& box, uint32_t ref)
+{
+  // values outside the node box would be clamped, shrinking the box
+  assert(contains(nodeBox, box));
+
+  Node& n = _nodes[node];
+  n.child[slot] = ref;
+
+  // round outward by an extra step so the box is still contained after
+  // any difference in decoding arithmetic
+  const Vec3 ext = nodeBox.pmax - nodeBox.pmin;
+  for (unsigned int i = 0; i < 3; ++i) {
+    if (ext[i] <= 0.0) {
+      n.box[slot][i] = 0;
+      n.box[slot][i + 3] = 0;
+      continue;
+    }
+
+    const Flt lo = std::floor((box.pmin[i] - nodeBox.pmin[i])
+                              / ext[i] * QUANT_MAX) - 1.0;
+    const Flt hi = std::ceil((box.pmax[i] - nodeBox.pmin[i])
+                             / ext[i] * QUANT_MAX) + 1.0;
+    n.box[slot][i] = uint16_t(std::clamp(lo, 0.0, QUANT_MAX));
+    n.box[slot][i + 3] = uint16_t(std::clamp(hi, 0.0, QUANT_MAX));
+  }
+
+  return decodeBox(nodeBox, quantScale(nodeBox), n.box[slot]);
+}
+
+int QuantizedBounds::intersect(uint32_t node, const BBox& nodeBox,
+                               const Ray& r, HitList& hl) const
+{
+  return traverse<false>(node, nodeBox, r, hl);
+}
+
+bool QuantizedBounds::occludes(uint32_t node, const BBox& nodeBox,
+                               const Ray& r, HitList& hl) const
+{
+  return traverse<true>(node, nodeBox, r, hl) > 0;
+}
+
+template<bool ANY_HIT>
+int QuantizedBounds::traverse(uint32_t node, const BBox& nodeBox,
+                              const Ray& r, HitList& hl) const
+{
+  StatInfo& stats = hl.stats();
+
+  const Vec3 invDir = r.inverseDir();
+
+  // depth first traversal - the current node box is kept in locals and
+  // the stack only holds deferred siblings (at most 1 per tree level)
+  struct Entry { uint32_t node; BBox box{INIT_NONE}; };
+  Entry stack[MAX_DEPTH + 1];
+  int top = 0;
+  uint32_t current = node;
+  BBox box = nodeBox;
+
+  int hits = 0;
+  for (;;) {
+    const Node& n = _nodes[current];
+    const Vec3 scale = quantScale(box);
+
+    // slab distance for quantized value q is q * a + c
+    // (child boxes are decoded only when visited)
+    const Vec3 a = scale * invDir;
+    const Vec3 c = (box.pmin - r.base) * invDir;
+    const Flt a6[6] = {a.x, a.y, a.z, a.x, a.y, a.z};
+    const Flt c6[6] = {c.x, c.y, c.z, c.x, c.y, c.z};
+    Flt h[2][6];
+    for (int slot = 0; slot < 2; ++slot) {
+      for (int i = 0; i < 6; ++i) {
+        h[slot][i] = (Flt(n.box[slot][i]) * a6[i]) + c6[i];
+      }
+    }
+
+    int visit[2];
+    int visitCount = 0;
+    for (int slot = 0; slot < 2; ++slot) {
+      const uint32_t ref = n.child[slot];
+      if (ref == EMPTY_REF) { continue; }
+
+      ++stats.bound.tried;
+      const Flt (&hs)[6] = h[slot];
+      const Flt near_hit = std::max({std::min(hs[0], hs[3]),
+                                     std::min(hs[1], hs[4]),
+                                     std::min(hs[2], hs[5])});
+      const Flt far_hit = std::min({std::max(hs[0], hs[3]),
+                                    std::max(hs[1], hs[4]),
+                                    std::max(hs[2], hs[5])});
+
+      if (near_hit > far_hit
+          || far_hit < r.min_length || near_hit >= r.max_length) {
+        continue;  // miss
+      }
+      ++stats.bound.hit;
+
+      if (!(ref & LEAF_FLAG)) {
+        visit[visitCount++] = slot;
+        continue;
+      }
+
+      const uint32_t start = ref & 0xffffff;
+      const uint32_t end = start + ((ref >> 24) & MAX_LEAF_SIZE);
+      for (uint32_t i = start; i < end; ++i) {
+        if constexpr (ANY_HIT) {
+          if (_objects[i]->occludes(r, hl)) { return 1; }
+        } else {
+          hits += _objects[i]->intersect(r, hl);
+        }
+      }
+    }
+
+    if (visitCount == 0) {
+      if (top == 0) { break; }
+      --top;
+      current = stack[top].node;
+      box = stack[top].box;
+      continue;
+    }
+
+    if (visitCount == 2) {
+      assert(top <= MAX_DEPTH);
+      stack[top++] = {n.child[1], decodeBox(box, scale, n.box[1])};
+    }
+
+    const int slot = visit[0];
+    current = n.child[slot];
+    box = decodeBox(box, scale, n.box[slot]);
+  }
+
+  return hits;
+}
@@ -0,0 +1,65 @@
+//
+// QuantizedBounds.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// compressed bound hierarchy for ray traversal
+// (binary nodes with child boxes quantized to 16 bits relative to the
+//  parent box - rounded outward so decoded boxes always contain the
+//  original boxes)
+//
+
+#pragma once
+#include "BBox.hh"
+#include "Types.hh"
+#include <vector>
+#include <span>
+#include <cstdint>
+
+
+// **** Types ****
+class Object;
+
+class QuantizedBounds
+{
+ public:
+  static constexpr uint32_t MAX_LEAF_SIZE = 127;
+  static constexpr int MAX_DEPTH = 63;  // traversal stack limit
+
+  // Member Functions
+  [[nodiscard]] uint32_t addNode();
+  [[nodiscard]] uint32_t addLeaf(std::span<const Object* const> objects);
+    // returns child reference for leaf (objects in test order)
+  BBox setChild(uint32_t node, const BBox& nodeBox, int slot,
+                const BBox& box, uint32_t ref);
+    // returns decoded child box (contains box)
+
+  int intersect(uint32_t node, const BBox& nodeBox,
+                const Ray& r, HitList& hl) const;
+  [[nodiscard]] bool occludes(uint32_t node, const BBox& nodeBox,
+                              const Ray& r, HitList& hl) const;
+    // nodeBox is the decoded box of the starting node
+    // (caller tests the ray against the node box)
+
+  [[nodiscard]] bool empty() const { return _nodes.empty(); }
+  [[nodiscard]] std::size_t nodeCount() const { return _nodes.size(); }
+  [[nodiscard]] std::size_t memorySize() const {
+    return (_nodes.size() * sizeof(Node))
+      + (_objects.size() * sizeof(const Object*)); }
+
+ private:
+  static constexpr uint32_t LEAF_FLAG = 0x80000000;
+  static constexpr uint32_t EMPTY_REF = 0xffffffff;
+
+  struct Node {
+    uint16_t box[2][6];  // child boxes (min xyz, max xyz)
+    uint32_t child[2];            // node index or leaf reference
+  };
+  static_assert(sizeof(Node) == 32);
+
+  std::vector<Node> _nodes;
+  std::vector<const Object*> _objects;
+
+  template<bool ANY_HIT>
+  int traverse(uint32_t node, const BBox& nodeBox,
+               const Ray& r, HitList& hl) const;
+};
@@ -0,0 +1,61 @@
+//
+// Random.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// small, fast random number generator (PCG32) & seed hashing functions
+//
+
+#pragma once
+#include "Types.hh"
+#include <cstdint>
+
+
+// **** Functions ****
+[[nodiscard]] constexpr uint64_t mixBits(uint64_t x)
+{
+  // splitmix64 finalizer
+  x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+[[nodiscard]] constexpr uint64_t hashCombine(uint64_t seed, uint64_t v)
+{
+  return mixBits(seed + 0x9e3779b97f4a7c15ULL + v);
+}
+
+
+// **** Types ****
+class PCG32
+{
+ public:
+  // UniformRandomBitGenerator interface
+  using result_type = uint32_t;
+  [[nodiscard]] static constexpr result_type min() { return 0; }
+  [[nodiscard]] static constexpr result_type max() { return 0xffffffffu; }
+
+  constexpr PCG32() = default;
+  constexpr explicit PCG32(uint64_t s) { seed(s); }
+
+  // Member Functions
+  constexpr void seed(uint64_t s) {
+    _state = 0; (void)next(); _state += s; (void)next(); }
+
+  constexpr result_type operator()() { return next(); }
+
+  [[nodiscard]] constexpr Flt uniform() {
+    return Flt(next()) * (1.0 / 4294967296.0); }
+    // uniform value in [0,1) range
+
+ private:
+  uint64_t _state = 0x853c49e6748fea9bULL;
+
+  [[nodiscard]] constexpr uint32_t next() {
+    const uint64_t old = _state;
+    _state = (old * 6364136223846793005ULL) + 1442695040888963407ULL;
+    const auto xorshifted = uint32_t(((old >> 18) ^ old) >> 27);
+    const auto rot = uint32_t(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+  }
+};
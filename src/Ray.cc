@@ -4,6 +4,18 @@
 //
 
 #include "Ray.hh"
+#include <cmath>
+
+
+// **** Ray Class ****
+Vec3 Ray::inverseDir() const
+{
+  Vec3 inv{INIT_NONE};
+  for (unsigned int i = 0; i < 3; ++i) {
+    inv[i] = 1.0 / ((std::abs(dir[i]) > VERY_SMALL) ? dir[i] : VERY_SMALL);
+  }
+  return inv;
+}
 
 
 // **** Functions ****
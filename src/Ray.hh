@@ -10,6 +10,14 @@
 
 
 // **** Types ****
+struct RayDifferentials
+{
+  // ray differentials (Igehy 1999)
+  // (change in base & dir for a one sample step across the image in x & y)
+  Vec3 dPdx{0,0,0}, dPdy{0,0,0};
+  Vec3 dDdx{0,0,0}, dDdy{0,0,0};
+};
+
 class Ray
 {
  public:
@@ -19,12 +27,20 @@ class Ray
   Flt  min_length = 0;
   Flt  max_length = VERY_LARGE;
   int  depth = 0;
+  Flt  weight = 1.0;  // max contribution of ray color to the final pixel
+  const RayDifferentials* diff = nullptr;
+    // only set for camera & reflection rays when a shader needs them
+    // (owned by the ray's creator)
 
   // Member Functions
   void moveOut(Flt amount) { base += dir * amount; }
 
   [[nodiscard]] bool inRange(Flt t) const {
     return (t >= min_length) && (t < max_length); }
+
+  [[nodiscard]] Vec3 inverseDir() const;
+    // for box slab tests (zero components are replaced with a tiny value
+    // to keep slab distances finite)
 };
 
 
@@ -5,16 +5,55 @@
 
 #include "Renderer.hh"
 #include "Scene.hh"
+#include "Object.hh"
+#include "Bound.hh"
+#include "Frustum.hh"
 #include "FrameBuffer.hh"
-#include "RandomDist.hh"
 #include "Ray.hh"
 #include "Color.hh"
 #include "Print.hh"
+#include "SpaceCurve.hh"
 #include <chrono>
+#include <atomic>
 #include <algorithm>
+#include <bit>
 #include <cassert>
 
 
+namespace {
+  constexpr int WAVEFRONT_BATCH_SIZE = 256;
+    // primary rays traced together for wavefront render
+
+  [[nodiscard]] uint32_t directionKey(const Vec3& dir)
+  {
+    // ray octant & coarse direction inside octant for sorting queued rays
+    const auto q = [](Flt v) {
+      return uint32_t(std::min(Abs(v), 1.0) * 15.0); };
+    const uint32_t octant = ((dir.x < 0.0) ? 1u : 0u)
+      | ((dir.y < 0.0) ? 2u : 0u) | ((dir.z < 0.0) ? 4u : 0u);
+    return (octant << 8) | (q(dir.x) << 4) | q(dir.y);
+  }
+  constexpr uint32_t DIRECTION_KEYS = 8 << 8;
+
+  void sortQueue(JobState& js, uint32_t keyCount)
+  {
+    // stable counting sort of queue indices by key
+    // (keys are small & ties stay in queue order so result doesn't
+    //  depend on sort implementation)
+    const std::size_t count = js.queueKeys.size();
+    auto& counts = js.keyCounts;
+    counts.assign(keyCount + 1, 0);
+    for (uint32_t k : js.queueKeys) { ++counts[k + 1]; }
+    for (uint32_t k = 1; k <= keyCount; ++k) { counts[k] += counts[k - 1]; }
+
+    js.queueOrder.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      js.queueOrder[std::size_t(counts[js.queueKeys[i]]++)] = int(i);
+    }
+  }
+}
+
+
 // **** Renderer class ****
 int Renderer::init(const Scene* s, FrameBuffer* fb)
 {
@@ -58,6 +97,18 @@ int Renderer::init(const Scene* s, FrameBuffer* fb)
 
   // init frame buffer
   _fb->init(s->image_width, s->image_height);
+  if (s->denoise > 0) {
+    _denoiser.init(s->image_width, s->image_height,
+                   s->region_min[0], s->region_min[1],
+                   s->region_max[0], s->region_max[1]);
+  }
+
+  _filter.init(s->filter, s->filter_radius);
+  if (_filter.splat()) {
+    _splats.assign(std::size_t(s->image_width * s->image_height), Color{});
+  } else {
+    _splats = {};
+  }
 
   // setup sample points
   const int sampleX = std::max(s->sample_x, 1);
@@ -72,56 +123,535 @@ int Renderer::init(const Scene* s, FrameBuffer* fb)
     }
   }
 
+  // select render kernel
+  _features = 0;
+  if (isPositive(s->jitter)) { _features |= KERNEL_JITTER; }
+  if (isPositive(s->aperture)) { _features |= KERNEL_APERTURE; }
+  if (s->texture_filter && s->footprint_shader_count > 0) {
+    _features |= KERNEL_DIFFERENTIALS;
+  }
+  if (s->denoise > 0) { _features |= KERNEL_GUIDES; }
+  if (_filter.splat()) { _features |= KERNEL_SPLAT; }
+  if (s->msaa) { _features |= KERNEL_MSAA; }
+  _wavefront = s->wavefront
+    && !(_features & (KERNEL_GUIDES | KERNEL_SPLAT | KERNEL_MSAA));
+
+  const unsigned fast = _features & KERNEL_FAST_FEATURES;
+  constexpr auto fastSeq =
+    std::make_integer_sequence<unsigned,KERNEL_FAST_FEATURES + 1>{};
+  _kernelGrid = (fast == _features && sampleX == sampleY) ? sampleX : 0;
+  switch (_kernelGrid) {
+    case 1:  _sampleFn = fastKernel<1>(fast, fastSeq); break;
+    case 2:  _sampleFn = fastKernel<2>(fast, fastSeq); break;
+    case 4:  _sampleFn = fastKernel<4>(fast, fastSeq); break;
+    default:
+      _kernelGrid = 0;
+      _sampleFn = &Renderer::samplePixel<KERNEL_DYNAMIC,0>;
+      break;
+  }
+
   return 0;
 }
 
+template<int GRID, unsigned... F>
+Renderer::SampleFn Renderer::fastKernel(
+  unsigned features, std::integer_sequence<unsigned,F...>)
+{
+  // table of kernels for every combination of fast features
+  // (fast feature flags are the low bits so features is the table index)
+  constexpr SampleFn table[] = {&Renderer::samplePixel<F,GRID>...};
+  return table[features];
+}
+
 void Renderer::render(JobState& js, int min_x, int min_y, int max_x, int max_y)
 {
-  const Flt halfWidth = Flt(_scene->image_width) * .5;
-  const Flt halfHeight = Flt(_scene->image_height) * .5;
-  const Vec3 eye = _scene->eye;
+  // visit pixels in morton order inside square blocks
+  // (a square tile is a single block, a scanline is a row of 1x1 blocks)
+  const int width = max_x - min_x + 1;
+  const int height = max_y - min_y + 1;
+  const int block = int(std::bit_ceil(unsigned(std::min(width, height))));
+  const uint32_t blockSize = uint32_t(block * block);
+  const bool useGuides = _scene->denoise > 0;
+  const bool splat = _filter.splat();
 
-  const bool use_jitter = isPositive(_scene->jitter);
-  const bool use_aperture = isPositive(_scene->aperture);
-  const int jitterCount =
-    use_jitter || use_aperture ? std::max(_scene->samples, 1) : 1;
-  const auto samplesInv = static_cast<Color::value_type>(
-    1.0 / double(int(_samples.size()) * jitterCount));
+  cullRegion(js, min_x, min_y, max_x, max_y);
+  if (_wavefront) {
+    renderWavefront(js, min_x, min_y, max_x, max_y);
+    return;
+  }
+
+  if (splat) {
+    // tile buffer covers region plus pixels within filter radius
+    const int apron = int(std::ceil(_filter.radius() + .5));
+    js.splatX = std::max(min_x - apron, _scene->region_min[0]);
+    js.splatY = std::max(min_y - apron, _scene->region_min[1]);
+    js.splatW = std::min(max_x + apron, _scene->region_max[0]) - js.splatX + 1;
+    js.splatH = std::min(max_y + apron, _scene->region_max[1]) - js.splatY + 1;
+    js.splatBuffer.assign(std::size_t(js.splatW * js.splatH), Color{});
+  }
+
+  for (int by = min_y; by <= max_y; by += block) {
+    for (int bx = min_x; bx <= max_x; bx += block) {
+      for (uint32_t i = 0; i < blockSize; ++i) {
+        const int x = bx + int(mortonX(i));
+        const int y = by + int(mortonY(i));
+        if (x > max_x || y > max_y) { continue; }
+
+        if (!useGuides) {
+          const Color c = (this->*_sampleFn)(js, x, y, nullptr);
+          if (!splat) { _fb->plot(x, y, c); }
+        } else {
+          PixelGuide guide;
+          const Color c = (this->*_sampleFn)(js, x, y, &guide);
+          if (!splat) { _fb->plot(x, y, c); }
+          _denoiser.setGuide(x, y, guide);
+        }
+      }
+    }
+  }
+
+  if (splat) { mergeSplats(js); }
+}
+
+template<unsigned FEATURES, int GRID>
+Vec2 Renderer::filmPoint(
+  JobState& js, Flt xx, Flt yy, int i, int g, int jitterCount) const
+{
+  Flt sx = xx, sy = yy;
+  if constexpr (GRID > 0) {
+    sx += (Flt(g % GRID) + .5) / Flt(GRID);
+    sy += (Flt(g / GRID) + .5) / Flt(GRID);
+  } else {
+    const Vec2& pt = _samples[std::size_t(g)];
+    sx += pt.x;
+    sy += pt.y;
+  }
+
+  if (feature<FEATURES>(KERNEL_JITTER)) {
+    const Vec2 j = js.rndJitterPt(i, jitterCount, g);
+    sx += j.x;
+    sy += j.y;
+  }
+  return {sx, sy};
+}
+
+template<unsigned FEATURES>
+Ray Renderer::cameraRay(JobState& js, Flt sx, Flt sy, int sample,
+                        int totalCount, Flt sampleStep,
+                        RayDifferentials& diff) const
+{
+  Ray r { .base = _scene->eye };
+  Vec3 dir = (_pixelX * sx) + (_pixelY * sy);
+  if (feature<FEATURES>(KERNEL_APERTURE)) {
+    const Vec2 a = js.rndAperturePt(sample, totalCount);
+    r.base = _scene->eye + (_apertureX * a.x) + (_apertureY * a.y);
+    dir += _vcenter - r.base;
+  } else {
+    dir += _vnormal;
+  }
+
+  r.dir = unitVec(dir);
+  if (feature<FEATURES>(KERNEL_DIFFERENTIALS)) {
+    // change in normalized ray direction for a sample step in x & y
+    // (sample step is clamped so high sample counts still get some
+    //  texture filtering)
+    const Flt len2 = dotProduct(dir, dir);
+    const Flt scale = sampleStep / (len2 * std::sqrt(len2));
+    diff.dDdx = ((_pixelX * len2) - (dir * dotProduct(dir, _pixelX))) * scale;
+    diff.dDdy = ((_pixelY * len2) - (dir * dotProduct(dir, _pixelY))) * scale;
+    r.diff = &diff;
+  }
+  return r;
+}
+
+void Renderer::cullRegion(
+  JobState& js, int min_x, int min_y, int max_x, int max_y) const
+{
+  // primary rays of a pinhole camera share a frustum so objects outside
+  // the region's frustum are culled before rendering it
+  // (rays that miss all remaining objects go straight to the background)
+  js.primaryObjects.clear();
+  if (isPositive(_scene->aperture)) {
+    for (auto& ob : _scene->optObjects()) {
+      js.primaryObjects.push_back(ob.get()); }
+    return;
+  }
 
-  Ray initRay { .base = eye };
+  // region edges on image plane (expanded for jitter)
+  const Flt m = (.5 * std::max(_scene->jitter, 0.0)) + .01;
+  const Flt x0 = Flt(min_x) - (Flt(_scene->image_width) * .5) - m;
+  const Flt x1 = Flt(max_x + 1) - (Flt(_scene->image_width) * .5) + m;
+  const Flt y0 = Flt(min_y) - (Flt(_scene->image_height) * .5) - m;
+  const Flt y1 = Flt(max_y + 1) - (Flt(_scene->image_height) * .5) + m;
+  const auto corner = [&](Flt sx, Flt sy) {
+    return (_pixelX * sx) + (_pixelY * sy) + _vnormal; };
+
+  Frustum f;
+  f.init(_scene->eye,
+         {corner(x0, y0), corner(x1, y0), corner(x1, y1), corner(x0, y1)});
+
+  cullBoundList(f, _scene->optObjects(), js.primaryObjects);
+}
+
+void Renderer::renderWavefront(
+  JobState& js, int min_x, int min_y, int max_x, int max_y) const
+{
+  // region is rendered breadth first - all primary rays are generated,
+  // then each ray queue is intersected & shaded (queuing reflection &
+  // shadow rays) and the shadow queue is cast until no rays are left
+  const int width = max_x - min_x + 1;
+  const int height = max_y - min_y + 1;
+  const int block = int(std::bit_ceil(unsigned(std::min(width, height))));
+  const uint32_t blockSize = uint32_t(block * block);
+
+  const bool multiSample =
+    (_features & (KERNEL_JITTER | KERNEL_APERTURE)) != 0;
+  const int jitterCount = multiSample ? std::max(_scene->samples, 1) : 1;
+  const int sampleCount = int(_samples.size());
+  const int totalCount = sampleCount * jitterCount;
+  const auto sw = static_cast<Color::value_type>(1.0 / double(totalCount));
+  const Color sampleWeight{sw, sw, sw};
+  const Flt sampleStep = std::max(1.0 / std::sqrt(Flt(totalCount)), .125);
+
+  js.tileColors.assign(std::size_t(width * height), colors::black);
+  js.rayQueue.clear();
+  js.nextRayQueue.clear();
+  js.shadowQueue.clear();
+
+  // generate primary rays (pixels in morton order)
+  for (int by = min_y; by <= max_y; by += block) {
+    for (int bx = min_x; bx <= max_x; bx += block) {
+      for (uint32_t i = 0; i < blockSize; ++i) {
+        const int x = bx + int(mortonX(i));
+        const int y = by + int(mortonY(i));
+        if (x > max_x || y > max_y) { continue; }
+
+        const int pixel = ((y - min_y) * width) + (x - min_x);
+        const Flt xx = Flt(x) - (Flt(_scene->image_width) * .5);
+        const Flt yy = Flt(y) - (Flt(_scene->image_height) * .5);
+        js.startPixel(x, y);
+        for (int j = 0; j < jitterCount; ++j) {
+          for (int g = 0; g < sampleCount; ++g) {
+            const int sample = (j * sampleCount) + g;
+            js.startSample(sample);
+            const Vec2 fp = filmPoint<KERNEL_DYNAMIC,0>(
+              js, xx, yy, j, g, jitterCount);
+            RayDifferentials diff;
+            const Ray r = cameraRay<KERNEL_DYNAMIC>(
+              js, fp.x, fp.y, sample, totalCount, sampleStep, diff);
+            js.rayQueue.push_back({r, diff, sampleWeight, pixel, sample});
+          }
+        }
+
+        // trace rays in batches so queues stay in cache
+        if (int(js.rayQueue.size()) >= WAVEFRONT_BATCH_SIZE) {
+          traceQueues(js, min_x, min_y, width, totalCount);
+        }
+      }
+    }
+  }
+  traceQueues(js, min_x, min_y, width, totalCount);
 
-  // start rendering
   for (int y = min_y; y <= max_y; ++y) {
-    const Flt yy = Flt(y) - halfHeight;
     for (int x = min_x; x <= max_x; ++x) {
-      const Flt xx = Flt(x) - halfWidth;
-
-      Color c{colors::black};
-      for (int i = 0; i < jitterCount; ++i) {
-        for (const Vec2& pt : _samples) {
-          Flt sx = xx + pt.x;
-          Flt sy = yy + pt.y;
-          if (use_jitter) {
-            sx += js.rndJitterX();
-            sy += js.rndJitterY();
-          }
+      _fb->plot(x, y, js.tileColors[
+        std::size_t(((y - min_y) * width) + (x - min_x))]);
+    }
+  }
+}
 
-          Vec3 dir = (_pixelX * sx) + (_pixelY * sy);
-          if (use_aperture) {
-            const Vec2 r = js.rndAperturePt();
-            initRay.base = eye + (_apertureX * r.x) + (_apertureY * r.y);
-            dir += _vcenter - initRay.base;
-          } else {
-            dir += _vnormal;
-          }
+void Renderer::traceQueues(
+  JobState& js, int min_x, int min_y, int width, int totalCount) const
+{
+  const auto lightKeys = uint32_t(_scene->lights().size() + 1);
+  const auto& order = js.queueOrder;
+  js.wavefront = true;
+  for (int depth = 0; !js.rayQueue.empty(); ++depth) {
+    // sort secondary rays by direction
+    // (primary rays are already coherent in pixel order)
+    const std::size_t count = js.rayQueue.size();
+    if (depth == 0) {
+      js.queueOrder.resize(count);
+      for (std::size_t i = 0; i < count; ++i) { js.queueOrder[i] = int(i); }
+    } else {
+      js.queueKeys.clear();
+      for (auto& q : js.rayQueue) {
+        js.queueKeys.push_back(directionKey(q.ray.dir));
+      }
+      sortQueue(js, DIRECTION_KEYS);
+    }
+
+    // intersect
+    // (primary rays only test objects in region frustum)
+    js.hitQueue.resize(count);
+    for (int i : order) {
+      HitInfo& h = js.hitQueue[std::size_t(i)];
+      const Ray& r = js.rayQueue[std::size_t(i)].ray;
+      const bool found = (depth == 0)
+        ? _scene->findHit(js, r, h, js.primaryObjects)
+        : _scene->findHit(js, r, h);
+      if (!found) { h.object = nullptr; }
+    }
+
+    // shade (reflection & shadow rays are queued)
+    for (int i : order) {
+      auto& q = js.rayQueue[std::size_t(i)];
+      const HitInfo& h = js.hitQueue[std::size_t(i)];
+      if (q.ray.diff) { q.ray.diff = &q.diff; }
+      js.startQueuedSample(min_x + (q.pixel % width),
+                           min_y + (q.pixel / width),
+                           q.sample + (depth * totalCount));
+      js.pathWeight = q.weight;
+      js.pathPixel = q.pixel;
+      js.pathSample = q.sample;
+      const Color c = h.object ? _scene->shadeHit(js, q.ray, h)
+        : _scene->shadeBackground(js, q.ray);
+      js.tileColors[std::size_t(q.pixel)] += c * q.weight;
+    }
+
+    // cast shadow rays grouped by light
+    // (rays for each light stay in pixel order so the light's last
+    //  occluder is likely to block the next ray too)
+    js.queueKeys.clear();
+    for (auto& sq : js.shadowQueue) {
+      js.queueKeys.push_back(uint32_t(sq.light + 1));
+    }
+    sortQueue(js, lightKeys);
+
+    for (int i : order) {
+      const auto& sq = js.shadowQueue[std::size_t(i)];
+      const Ray sray {
+        .base       = sq.base,
+        .dir        = sq.dir,
+        .min_length = sq.min_length,
+        .max_length = sq.max_length
+      };
+      if (!_scene->castShadowRay(js, sray, sq.light, sq.grid)) {
+        js.tileColors[std::size_t(sq.pixel)] += sq.value;
+      }
+    }
+
+    js.shadowQueue.clear();
+    js.rayQueue.swap(js.nextRayQueue);
+    js.nextRayQueue.clear();
+  }
+  js.wavefront = false;
+}
+
+template<unsigned FEATURES, int GRID>
+Color Renderer::samplePixel(
+  JobState& js, int x, int y, PixelGuide* guide) const
+{
+  const Flt xx = Flt(x) - (Flt(_scene->image_width) * .5);
+  const Flt yy = Flt(y) - (Flt(_scene->image_height) * .5);
+  const Flt halfW = Flt(_scene->image_width) * .5;
+  const Flt halfH = Flt(_scene->image_height) * .5;
+  const bool splat = feature<FEATURES>(KERNEL_SPLAT);
+  const bool use_guides = feature<FEATURES>(KERNEL_GUIDES);
+
+  const bool use_jitter = feature<FEATURES>(KERNEL_JITTER);
+  const bool use_aperture = feature<FEATURES>(KERNEL_APERTURE);
+  const int jitterCount =
+    use_jitter || use_aperture ? std::max(_scene->samples, 1) : 1;
+  const int sampleCount = GRID ? (GRID * GRID) : int(_samples.size());
+  const int totalCount = sampleCount * jitterCount;
+  const auto samplesInv =
+    static_cast<Color::value_type>(1.0 / double(totalCount));
+
+  // ray differentials cover the image area of a single sample
+  const Flt sampleStep = std::max(1.0 / std::sqrt(Flt(totalCount)), .125);
+  const bool msaa = feature<FEATURES>(KERNEL_MSAA) && (totalCount > 1);
+  js.startPixel(x, y);
+  js.sampleGroups.clear();
+  js.groupSamples.clear();
+
+  Flt lumSum = 0, lumSqrSum = 0;
+  int shadeCount = 0;
+  const auto shade = [&](const Ray& r, const HitInfo* hit, int count) {
+    const auto weight = Color::value_type(count);
+    if (!use_guides) {
+      return (hit ? _scene->shadeHit(js, r, *hit)
+              : _scene->shadeBackground(js, r)) * weight;
+    }
+
+    js.captureSurface = true;
+    const Color sc = hit ? _scene->shadeHit(js, r, *hit)
+      : _scene->shadeBackground(js, r);
+
+    // denoise guide values
+    // (unlit shaders & background are their own albedo)
+    const bool unlit = js.captureSurface;
+    js.captureSurface = false;
+    const Color albedo = unlit ? sc : js.albedo;
+    const Color specular = unlit ? colors::black : js.specular;
+    guide->albedo += albedo * weight;
+    guide->specular += specular * weight;
+
+    const Flt lum = Flt(demodulate(sc, specular, albedo).cieLuminance());
+    ++shadeCount;
+    lumSum += lum * Flt(count);
+    lumSqrSum += lum * lum * Flt(count);
 
-          initRay.dir = unitVec(dir);
-          c += _scene->traceRay(js, initRay);
+    if (hit) {
+      Vec3 n = hit->object->normal(r, *hit);
+      if (dotProduct(r.dir, n) > 0.0) { n = -n; }
+      guide->normal += n * Flt(count);
+      guide->depth += hit->distance * Flt(count);
+    }
+    return sc * weight;
+  };
+
+  Color c{colors::black};
+  for (int i = 0; i < jitterCount; ++i) {
+    for (int g = 0; g < sampleCount; ++g) {
+      const int sample = (i * sampleCount) + g;
+      js.startSample(sample);
+      const Vec2 fp = filmPoint<FEATURES,GRID>(js, xx, yy, i, g, jitterCount);
+      const Flt sx = fp.x, sy = fp.y;
+      RayDifferentials diff;
+      const Ray initRay = cameraRay<FEATURES>(
+        js, sx, sy, sample, totalCount, sampleStep, diff);
+      if (msaa) {
+        const int sg = addSampleGroup(js, initRay, diff, sample,
+                                      sqr(sx - xx - .5) + sqr(sy - yy - .5));
+        if (splat) {
+          js.groupSamples.push_back({{sx + halfW, sy + halfH}, sg});
         }
+        continue;
+      }
+
+      HitInfo hit;
+      const bool isHit =
+        _scene->findHit(js, initRay, hit, js.primaryObjects);
+      Color sc;
+      if (!use_guides) {
+        sc = isHit ? _scene->shadeHit(js, initRay, hit)
+          : _scene->shadeBackground(js, initRay);
+      } else {
+        sc = shade(initRay, isHit ? &hit : nullptr, 1);
       }
 
-      c *= samplesInv;
-      _fb->plot(x, y, c);
+      c += sc;
+      if (splat) { splatSample(js, sx + halfW, sy + halfH, sc); }
+    }
+  }
+
+  if (msaa) {
+    // shade each group once, weighted by its sample count
+    for (auto& sg : js.sampleGroups) {
+      js.startSample(sg.sample);
+      if (sg.ray.diff) { sg.ray.diff = &sg.diff; }
+      const Color gc = shade(sg.ray, sg.hit.object ? &sg.hit : nullptr,
+                             sg.count);
+      c += gc;
+      sg.color = gc / Color::value_type(sg.count);
+    }
+
+    // every sample splats the color of its group
+    for (auto& gs : js.groupSamples) {
+      splatSample(js, gs.pos.x, gs.pos.y,
+                  js.sampleGroups[std::size_t(gs.group)].color);
+    }
+  }
+
+  if (use_guides) {
+    const Flt inv = Flt(samplesInv);
+    guide->normal *= inv;
+    guide->depth *= inv;
+    guide->albedo *= samplesInv;
+    guide->specular *= samplesInv;
+    if (shadeCount > 1) {
+      // variance of pixel mean
+      const Flt mean = lumSum * inv;
+      guide->variance =
+        std::max((lumSqrSum * inv) - sqr(mean), 0.0) / Flt(shadeCount - 1);
+    }
+  }
+
+  c *= samplesInv;
+  return c;
+}
+
+int Renderer::addSampleGroup(
+  JobState& js, const Ray& r, const RayDifferentials& diff, int sample,
+  Flt centerDist) const
+{
+  HitInfo hit;
+  hit.object = nullptr;
+  hit.side = 0;
+  Vec3 normal{0,0,0};
+  if (_scene->findHit(js, r, hit, js.primaryObjects)) {
+    normal = hit.object->normal(r, hit);
+  }
+
+  // visibility resolved per sample, samples grouped by object hit
+  // (& by normal so curved surfaces get more than one shading point)
+  constexpr Flt MIN_NORMAL_DOT = .985;  // ~10 degrees
+  const int groups = int(js.sampleGroups.size());
+  for (int i = 0; i < groups; ++i) {
+    auto& sg = js.sampleGroups[std::size_t(i)];
+    if (sg.hit.object == hit.object && sg.hit.side == hit.side
+        && (!hit.object || dotProduct(sg.normal, normal) > MIN_NORMAL_DOT)) {
+      ++sg.count;
+      if (centerDist < sg.centerDist) {
+        sg.hit = hit;
+        sg.ray = r;
+        sg.diff = diff;
+        sg.centerDist = centerDist;
+        sg.sample = sample;
+      }
+      return i;
+    }
+  }
+
+  js.sampleGroups.push_back(
+    {hit, r, diff, normal, colors::black, centerDist, sample, 1});
+  return groups;
+}
+
+void Renderer::splatSample(
+  JobState& js, Flt fx, Flt fy, const Color& c) const
+{
+  // film position (fx,fy) is splatted into all pixels with centers within
+  // filter radius
+  const Flt r = _filter.radius();
+  const int x0 = std::max(int(std::floor(fx - r - .5)) + 1, js.splatX);
+  const int y0 = std::max(int(std::floor(fy - r - .5)) + 1, js.splatY);
+  const int x1 = std::min(int(std::ceil(fx + r - .5)) - 1,
+                          js.splatX + js.splatW - 1);
+  const int y1 = std::min(int(std::ceil(fy + r - .5)) - 1,
+                          js.splatY + js.splatH - 1);
+
+  for (int y = y0; y <= y1; ++y) {
+    Color* row = &js.splatBuffer[std::size_t((y - js.splatY) * js.splatW)];
+    const Flt dy = fy - (Flt(y) + .5);
+    for (int x = x0; x <= x1; ++x) {
+      const float w = _filter(fx - (Flt(x) + .5), dy);
+      Color& p = row[x - js.splatX];
+      p[0] += c[0] * w;
+      p[1] += c[1] * w;
+      p[2] += c[2] * w;
+      p[3] += w;
+    }
+  }
+}
+
+void Renderer::mergeSplats(const JobState& js)
+{
+  // tile buffers of neighboring regions overlap so values are added
+  // atomically (no locking needed)
+  const int width = _scene->image_width;
+  for (int y = 0; y < js.splatH; ++y) {
+    for (int x = 0; x < js.splatW; ++x) {
+      const Color& src = js.splatBuffer[std::size_t((y * js.splatW) + x)];
+      if (src[3] == 0.0f) { continue; }
+
+      Color& dst = _splats[
+        std::size_t(((js.splatY + y) * width) + js.splatX + x)];
+      for (Color::size_type i = 0; i < Color::CHANNELS; ++i) {
+        std::atomic_ref<float>{dst[i]}.fetch_add(
+          src[i], std::memory_order_relaxed);
+      }
     }
   }
 }
@@ -129,7 +659,31 @@ void Renderer::render(JobState& js, int min_x, int min_y, int max_x, int max_y)
 void Renderer::setJobs(int jobs)
 {
   if (jobs < 0) { jobs = 0; }
-  _jobs.resize(std::size_t(jobs));
+  const auto count = std::size_t(jobs);
+
+  // shutdown extra jobs
+  if (count < _jobs.size()) {
+    {
+      std::lock_guard lock{_poolMutex};
+      for (std::size_t i = count; i < _jobs.size(); ++i) {
+        _jobs[i]->quit = true;
+      }
+    }
+    _poolCV.notify_all();
+    for (std::size_t i = count; i < _jobs.size(); ++i) {
+      _jobs[i]->jobThread.join();
+    }
+    _jobs.resize(count);
+  }
+
+  // start new jobs (existing jobs keep their thread & state)
+  while (_jobs.size() < count) {
+    auto j = std::make_unique<Job>();
+    j->jobThread =
+      std::thread{&Renderer::jobMain, this, j.get(), int(_jobs.size()),
+                  _renderID};
+    _jobs.push_back(std::move(j));
+  }
 }
 
 void Renderer::startJobs()
@@ -137,63 +691,208 @@ void Renderer::startJobs()
   assert(!_jobs.empty());
 
   // make render tasks
-  const int num = std::max(jobs(), 4) * 20;
-  const int height = _scene->region_max[1] - _scene->region_min[1];
-  const int inc_y = std::clamp(height / num, 1, 16);
-  const int max_y = _scene->region_max[1];
-  for (int y = _scene->region_min[1]; y <= max_y; y += inc_y) {
-    const int yend = std::min(y + inc_y - 1, max_y);
-    _tasks.push_back({_scene->region_min[0], y, _scene->region_max[0], yend});
+  // (square tiles sorted along a hilbert curve so consecutive tasks are
+  //  spatially close)
+  const int tileSize = std::max(_scene->tile_size, 1);
+  const int min_x = _scene->region_min[0], max_x = _scene->region_max[0];
+  const int min_y = _scene->region_min[1], max_y = _scene->region_max[1];
+  const int tilesX = ((max_x - min_x) / tileSize) + 1;
+  const int tilesY = ((max_y - min_y) / tileSize) + 1;
+  const uint32_t curveSize = std::bit_ceil(unsigned(std::max(tilesX, tilesY)));
+
+  std::vector<std::pair<uint32_t,Task>> tiles;
+  tiles.reserve(std::size_t(tilesX * tilesY));
+  for (int ty = 0; ty < tilesY; ++ty) {
+    const int y = min_y + (ty * tileSize);
+    for (int tx = 0; tx < tilesX; ++tx) {
+      const int x = min_x + (tx * tileSize);
+      tiles.push_back(
+        {hilbertIndex(curveSize, uint32_t(tx), uint32_t(ty)),
+         {x, y, std::min(x + tileSize - 1, max_x),
+          std::min(y + tileSize - 1, max_y)}});
+    }
   }
 
+  std::sort(tiles.begin(), tiles.end(),
+            [](auto& a, auto& b){ return a.first < b.first; });
+  _tasks.clear();
+  for (auto& [d,t] : tiles) { _tasks.push_back(t); }
+
   println("Jobs: ", jobs(), "   Tasks: ", _tasks.size(),
-          "   Task Size: ", _scene->image_width, "x", inc_y);
+          "   Task Size: ", tileSize, "x", tileSize, " tiles (hilbert order)");
+
+  for (auto& j : _jobs) { j->state.init(*_scene); }
+  _denoisePass = -1;
+  startTasks();
+}
+
+void Renderer::startTasks()
+{
+  // seed each job with a contiguous (spatially coherent) section of the curve
+  const int taskCount = int(_tasks.size());
+  const int jobCount = jobs();
+  _tasksRemaining = taskCount;
+  for (int i = 0; i < jobCount; ++i) {
+    Job& j = *_jobs[std::size_t(i)];
+    j.taskRanges.clear();
+    const int first = int((int64_t{taskCount} * i) / jobCount);
+    const int last = int((int64_t{taskCount} * (i+1)) / jobCount);
+    if (first < last) { j.taskRanges.push_back({first, last}); }
+  }
+
+  // wake render jobs
+  for (auto& j : _jobs) { j->halt = false; }
 
-  // start render jobs
-  for (auto& j : _jobs) {
-    j.state.init(*_scene);
-    j.halt = false;
-    j.jobThread = std::thread{&Renderer::jobMain, this, &j};
+  {
+    std::lock_guard lock{_poolMutex};
+    _activeJobs = jobCount;
+    ++_renderID;
   }
+  _poolCV.notify_all();
 }
 
 int Renderer::waitForJobs(int timeout_ms)
 {
   const std::chrono::milliseconds timeout{timeout_ms};
-  std::unique_lock lock{_tasksMutex};
-  while (!_tasks.empty()) {
-    if (_tasksCV.wait_for(lock, timeout) == std::cv_status::timeout) {
-      return int(_tasks.size()); // timeout
+  std::unique_lock lock{_doneMutex};
+  _doneCV.wait_for(lock, timeout, [this]{ return _tasksRemaining <= 0; });
+  return _tasksRemaining;
+}
+
+void Renderer::stopJobs()
+{
+  for (auto& j : _jobs) { j->halt = true; }
+  waitForIdle();
+  for (auto& j : _jobs) { _stats += j->state.stats; }
+}
+
+void Renderer::waitForIdle()
+{
+  std::unique_lock lock{_poolMutex};
+  _idleCV.wait(lock, [this]{ return _activeJobs == 0; });
+}
+
+void Renderer::finish()
+{
+  if (_filter.splat()) {
+    // resolve splatted samples
+    const int width = _scene->image_width;
+    for (int y = _scene->region_min[1]; y <= _scene->region_max[1]; ++y) {
+      for (int x = _scene->region_min[0]; x <= _scene->region_max[0]; ++x) {
+        const Color& s = _splats[std::size_t((y * width) + x)];
+        const float w = s[3];
+        _fb->plot(x, y, (w > 0.0f)
+                  ? Color{s[0] / w, s[1] / w, s[2] / w} : colors::black);
+      }
     }
   }
-  return 0; // done
+
+  denoise();
 }
 
-void Renderer::stopJobs()
+void Renderer::denoise()
 {
-  for (auto& j : _jobs) { j.halt = true; }
-  for (auto& j : _jobs) {
-    j.jobThread.join();
-    _stats += j.state.stats;
+  const int passes = _scene->denoise;
+  if (passes <= 0) { return; }
+
+  _denoiser.load(*_fb);
+  for (int p = 0; p < passes; ++p) {
+    if (_jobs.empty() || _tasks.empty()) {
+      _denoiser.filter(p, _scene->region_min[0], _scene->region_min[1],
+                       _scene->region_max[0], _scene->region_max[1]);
+    } else {
+      // pass must be complete before next one starts
+      _denoisePass = p;
+      startTasks();
+      waitForIdle();
+    }
   }
+  _denoisePass = -1;
+  _denoiser.store(*_fb, passes);
 }
 
-void Renderer::jobMain(Job* j)
+void Renderer::jobMain(Job* j, int jobNo, uint64_t lastRenderID)
 {
-  Task t;
+  for (;;) {
+    {
+      // sleep until next render
+      std::unique_lock lock{_poolMutex};
+      _poolCV.wait(lock, [&]{ return j->quit || _renderID != lastRenderID; });
+      if (j->quit) { return; }
+      lastRenderID = _renderID;
+    }
+
+    runTasks(j, jobNo);
+
+    {
+      std::lock_guard lock{_poolMutex};
+      if (--_activeJobs == 0) { _idleCV.notify_all(); }
+    }
+  }
+}
+
+void Renderer::runTasks(Job* j, int jobNo)
+{
+  int t;
   while (!j->halt) {
+    if (!popTask(j, t) && !stealTask(j, jobNo, t)) { break; }
+
+    const Task& task = _tasks[std::size_t(t)];
+    if (_denoisePass < 0) {
+      render(j->state, task.min_x, task.min_y, task.max_x, task.max_y);
+    } else {
+      _denoiser.filter(
+        _denoisePass, task.min_x, task.min_y, task.max_x, task.max_y);
+    }
+
+    if (--_tasksRemaining == 0) {
+      std::lock_guard lock{_doneMutex};
+      _doneCV.notify_all();
+    }
+  }
+}
+
+bool Renderer::popTask(Job* j, int& task)
+{
+  std::lock_guard lock{j->taskMutex};
+  if (j->taskRanges.empty()) { return false; }
+
+  TaskRange& r = j->taskRanges.front();
+  task = r.first++;
+  if (r.first == r.last) { j->taskRanges.pop_front(); }
+  return true;
+}
+
+bool Renderer::stealTask(Job* j, int jobNo, int& task)
+{
+  const int jobCount = jobs();
+  for (int i = 1; i < jobCount; ++i) {
+    Job* victim = _jobs[std::size_t((jobNo + i) % jobCount)].get();
+
+    TaskRange stolen;
     {
-      std::lock_guard lock{_tasksMutex};
-      if (_tasks.empty()) {
-	j->halt = true;
-	_tasksCV.notify_one();
-	break;
-      }
+      std::lock_guard lock{victim->taskMutex};
+      if (victim->taskRanges.empty()) { continue; }
 
-      t = _tasks.back();
-      _tasks.pop_back();
+      TaskRange& r = victim->taskRanges.back();
+      if ((r.last - r.first) > 1) {
+        // split large range - take back half
+        const int mid = r.first + ((r.last - r.first) / 2);
+        stolen = {mid, r.last};
+        r.last = mid;
+      } else {
+        stolen = r;
+        victim->taskRanges.pop_back();
+      }
     }
 
-    render(j->state, t.min_x, t.min_y, t.max_x, t.max_y);
+    task = stolen.first++;
+    if (stolen.first < stolen.last) {
+      std::lock_guard lock{j->taskMutex};
+      j->taskRanges.push_back(stolen);
+    }
+    return true;
   }
+
+  return false;
 }
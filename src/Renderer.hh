@@ -5,10 +5,16 @@
 
 #pragma once
 #include "JobState.hh"
+#include "Denoise.hh"
+#include "Filter.hh"
 #include "Types.hh"
 #include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 
 
@@ -16,23 +22,40 @@
 class Renderer
 {
  public:
+  Renderer() = default;
+  ~Renderer() { setJobs(0); }
+
+  // prevent copy/assign
+  Renderer(const Renderer&) = delete;
+  Renderer& operator=(const Renderer&) = delete;
+
   int init(const Scene* s, FrameBuffer* fb);
   void render(JobState& js, int min_x, int min_y, int max_x, int max_y);
+    // renders image region with pixels visited in morton order
+    // (or breadth first if scene uses wavefront rendering)
 
   // jobs/task methods
   [[nodiscard]] int jobs() const { return int(_jobs.size()); }
   void setJobs(int jobs);
     // number of jobs (thread) to execute render
+    // (job threads are persistent and sleep between renders - pool is
+    //  resized in place)
 
   void startJobs();
-    // creates render tasks and starts all render jobs
+    // creates render tasks (square tiles in hilbert curve order) and
+    // wakes all render jobs
 
   int waitForJobs(int timeout_ms);
-    // waits for jobs to finish task or timeout
-    // returns number of pending tasks
+    // waits for jobs to finish all tasks or timeout
+    // returns number of unfinished tasks
 
   void stopJobs();
-    // stops active jobs, returns once all jobs are halted
+    // stops active jobs, returns once all jobs are idle
+
+  void finish();
+    // completes image after all rendering is done
+    // (resolves splatted samples for reconstruction filter & runs scene
+    //  denoise filter passes)
 
   void setStats(const StatInfo& st) { _stats = st; }
   [[nodiscard]] const StatInfo& stats() const { return _stats; }
@@ -42,6 +65,33 @@ class Renderer
   FrameBuffer* _fb = nullptr;
   std::vector<Vec2> _samples;
   StatInfo _stats;
+  Denoiser _denoiser;
+  int _denoisePass = -1;  // filter pass run by tasks (-1 to render)
+  PixelFilter _filter;
+  std::vector<Color> _splats;  // filter weighted sample sums for each pixel
+                               // (alpha is filter weight sum)
+
+  // render kernel
+  // (samplePixel() specialized at compile time for the scene features
+  //  & common sample grid sizes so per-sample feature checks are removed)
+  enum KernelFeature : unsigned {
+    KERNEL_JITTER        = 1,
+    KERNEL_APERTURE      = 2,
+    KERNEL_DIFFERENTIALS = 4,
+    KERNEL_GUIDES        = 8,
+    KERNEL_SPLAT         = 16,
+    KERNEL_MSAA          = 32,
+    KERNEL_DYNAMIC       = 64  // features checked at runtime
+  };
+  static constexpr unsigned KERNEL_FAST_FEATURES =
+    KERNEL_JITTER | KERNEL_APERTURE | KERNEL_DIFFERENTIALS;
+    // features with specialized kernels (others use dynamic kernel)
+
+  using SampleFn = Color (Renderer::*)(JobState&, int, int, PixelGuide*) const;
+  SampleFn _sampleFn = nullptr;
+  unsigned _features = 0;
+  int _kernelGrid = 0;  // sample grid size of kernel (0 for dynamic)
+  bool _wavefront = false;
 
   // Calculated Data
   Vec3 _vnormal, _vcenter;
@@ -49,22 +99,80 @@ class Renderer
   Vec3 _apertureX, _apertureY;
 
   // jobs/task stuff
+  struct Task {
+    // image region to render for task
+    int min_x, min_y, max_x, max_y;
+  };
+  std::vector<Task> _tasks; // tiles in hilbert curve order
+
+  struct TaskRange {
+    // range of tasks in _tasks [first,last)
+    int first, last;
+  };
+
   struct alignas(64) Job {
     // thread local stuff
     // HitInfo pool
     std::thread jobThread;
     JobState state;
-    bool halt = false;
-  };
-  std::vector<Job> _jobs;
+    std::atomic<bool> halt = false;
+    bool quit = false; // guarded by _poolMutex
 
-  struct Task {
-    // image region to render for task
-    int min_x, min_y, max_x, max_y;
+    // work-stealing deque of task ranges
+    // (owner takes tasks from the front, thieves split ranges at the back)
+    std::deque<TaskRange> taskRanges;
+    std::mutex taskMutex;
   };
-  std::vector<Task> _tasks;
-  std::mutex _tasksMutex;
-  std::condition_variable _tasksCV;
+  std::vector<std::unique_ptr<Job>> _jobs;
+
+  std::atomic<int> _tasksRemaining = 0;
+  std::mutex _doneMutex;
+  std::condition_variable _doneCV;
+
+  // thread pool state
+  uint64_t _renderID = 0;  // incremented to wake jobs for a new render
+  int _activeJobs = 0;     // jobs still working on current render
+  std::mutex _poolMutex;
+  std::condition_variable _poolCV;
+  std::condition_variable _idleCV;
 
-  void jobMain(Job* j);
+  void startTasks();
+  void waitForIdle();
+  void denoise();
+  void jobMain(Job* j, int jobNo, uint64_t lastRenderID);
+  void runTasks(Job* j, int jobNo);
+  [[nodiscard]] bool popTask(Job* j, int& task);
+  [[nodiscard]] bool stealTask(Job* j, int jobNo, int& task);
+  template<unsigned FEATURES>
+  [[nodiscard]] bool feature(unsigned f) const {
+    return (FEATURES & KERNEL_DYNAMIC) ? (_features & f) : (FEATURES & f); }
+  template<unsigned FEATURES, int GRID>
+  [[nodiscard]] Vec2 filmPoint(
+    JobState& js, Flt xx, Flt yy, int i, int g, int jitterCount) const;
+    // image plane position of sub-pixel sample g for jitter pass i
+  template<unsigned FEATURES>
+  [[nodiscard]] Ray cameraRay(JobState& js, Flt sx, Flt sy, int sample,
+                              int totalCount, Flt sampleStep,
+                              RayDifferentials& diff) const;
+    // ray differentials are stored in 'diff' if the kernel tracks them
+  template<unsigned FEATURES, int GRID>
+  [[nodiscard]] Color samplePixel(
+    JobState& js, int x, int y, PixelGuide* guide) const;
+    // GRID is sample grid width/height (0 for scene sample grid)
+  template<int GRID, unsigned... F>
+  [[nodiscard]] static SampleFn fastKernel(
+    unsigned features, std::integer_sequence<unsigned,F...>);
+  [[nodiscard]] int addSampleGroup(
+    JobState& js, const Ray& r, const RayDifferentials& diff, int sample,
+    Flt centerDist) const;
+  void cullRegion(
+    JobState& js, int min_x, int min_y, int max_x, int max_y) const;
+    // sets primary ray objects for region
+  void renderWavefront(
+    JobState& js, int min_x, int min_y, int max_x, int max_y) const;
+  void traceQueues(
+    JobState& js, int min_x, int min_y, int width, int totalCount) const;
+    // traces queued primary rays & all rays they spawn
+  void splatSample(JobState& js, Flt fx, Flt fy, const Color& c) const;
+  void mergeSplats(const JobState& js);
 };
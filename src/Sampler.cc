@@ -0,0 +1,162 @@
+//
+// Sampler.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "Sampler.hh"
+#include <array>
+#include <bit>
+
+
+// **** Helper Functions ****
+[[nodiscard]] static constexpr Flt toUnit(uint32_t x)
+{
+  return Flt(x) * (1.0 / 4294967296.0);
+}
+
+[[nodiscard]] static constexpr Flt wrapUnit(Flt x)
+{
+  return (x >= 1.0) ? (x - 1.0) : x;
+}
+
+[[nodiscard]] static constexpr Flt radicalInverse3(uint32_t i)
+{
+  Flt inv = 1.0 / 3.0, f = inv, r = 0;
+  while (i > 0) {
+    r += f * Flt(i % 3);
+    i /= 3;
+    f *= inv;
+  }
+  return r;
+}
+
+[[nodiscard]] static constexpr uint32_t reverseBits(uint32_t x)
+{
+  x = ((x >> 1) & 0x55555555) | ((x & 0x55555555) << 1);
+  x = ((x >> 2) & 0x33333333) | ((x & 0x33333333) << 2);
+  x = ((x >> 4) & 0x0f0f0f0f) | ((x & 0x0f0f0f0f) << 4);
+  x = ((x >> 8) & 0x00ff00ff) | ((x & 0x00ff00ff) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+[[nodiscard]] static constexpr uint32_t sobolDim1(uint32_t i)
+{
+  // second dimension of sobol sequence (first is bit reversed index)
+  uint32_t r = 0;
+  for (uint32_t v = 1u << 31; i != 0; i >>= 1, v ^= v >> 1) {
+    if (i & 1) { r ^= v; }
+  }
+  return r;
+}
+
+[[nodiscard]] static constexpr uint32_t owenScramble(uint32_t x, uint32_t seed)
+{
+  // hash based nested uniform scramble (Laine-Karras permutation on
+  // reversed bits)
+  x = reverseBits(x);
+  x += seed;
+  x ^= x * 0x6c50b47cu;
+  x ^= x * 0xb82f1e52u;
+  x ^= x * 0xc7afe638u;
+  x ^= x * 0x8d22f6e6u;
+  return reverseBits(x);
+}
+
+
+// **** Blue Noise Table ****
+static constexpr int BLUE_NOISE_SIZE = 256;
+using BlueNoiseTable = std::array<Vec2,BLUE_NOISE_SIZE>;
+
+[[nodiscard]] static BlueNoiseTable makeBlueNoiseTable()
+{
+  // progressive blue noise points using Mitchell's best-candidate
+  // algorithm on a torus (any prefix of the table is well distributed)
+  BlueNoiseTable table;
+  uint64_t state = 0x2545f4914f6cdd1dULL;
+  auto rnd = [&state]{
+    state = hashCombine(state, 1);
+    return toUnit(uint32_t(state >> 32));
+  };
+
+  table[0] = {rnd(), rnd()};
+  for (int i = 1; i < BLUE_NOISE_SIZE; ++i) {
+    const int candidates = (i * 2) + 1;
+    Flt bestDist = -1;
+    for (int c = 0; c < candidates; ++c) {
+      const Vec2 pt{rnd(), rnd()};
+      Flt minDist = VERY_LARGE;
+      for (int j = 0; j < i; ++j) {
+        Flt dx = Abs(pt.x - table[std::size_t(j)].x);
+        Flt dy = Abs(pt.y - table[std::size_t(j)].y);
+        dx = std::min(dx, 1.0 - dx);
+        dy = std::min(dy, 1.0 - dy);
+        minDist = std::min(minDist, (dx * dx) + (dy * dy));
+      }
+
+      if (minDist > bestDist) {
+        bestDist = minDist;
+        table[std::size_t(i)] = pt;
+      }
+    }
+  }
+
+  return table;
+}
+
+[[nodiscard]] static const BlueNoiseTable& blueNoiseTable()
+{
+  static const BlueNoiseTable table = makeBlueNoiseTable();
+  return table;
+}
+
+
+// **** Sampler Class ****
+uint64_t Sampler::streamSeed(SampleDim dim, int stream) const
+{
+  return hashCombine(_pixelSeed, (uint64_t(stream) << 8) | uint64_t(dim));
+}
+
+Vec2 Sampler::halton(uint32_t index, uint64_t seed) const
+{
+  const Flt x = toUnit(reverseBits(index)); // radical inverse base 2
+  const Flt y = radicalInverse3(index);
+  return {wrapUnit(x + toUnit(uint32_t(seed))),
+          wrapUnit(y + toUnit(uint32_t(seed >> 32)))};
+}
+
+Vec2 Sampler::sobol(uint32_t index, uint64_t seed) const
+{
+  const uint64_t s2 = mixBits(seed);
+  const uint32_t i = owenScramble(index, uint32_t(s2));
+  return {toUnit(owenScramble(reverseBits(i), uint32_t(seed))),
+          toUnit(owenScramble(sobolDim1(i), uint32_t(seed >> 32)))};
+}
+
+Vec2 Sampler::blueNoise(uint32_t index, uint64_t seed) const
+{
+  const BlueNoiseTable& table = blueNoiseTable();
+  const Vec2& pt = table[index % BLUE_NOISE_SIZE];
+
+  // shift differs for each pass through the table
+  const uint64_t shift = hashCombine(seed, index / BLUE_NOISE_SIZE);
+  return {wrapUnit(pt.x + toUnit(uint32_t(shift))),
+          wrapUnit(pt.y + toUnit(uint32_t(shift >> 32)))};
+}
+
+
+// **** Functions ****
+bool findSamplerType(std::string_view name, SamplerType& type)
+{
+  static constexpr std::pair<std::string_view,SamplerType> types[] = {
+    {"random",     SAMPLER_RANDOM},
+    {"stratified", SAMPLER_STRATIFIED},
+    {"halton",     SAMPLER_HALTON},
+    {"sobol",      SAMPLER_SOBOL},
+    {"bluenoise",  SAMPLER_BLUENOISE}
+  };
+
+  for (auto& [n,t] : types) {
+    if (n == name) { type = t; return true; }
+  }
+  return false;
+}
@@ -0,0 +1,146 @@
+//
+// Sampler.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// sample point generators for sub-pixel jitter, aperture & hemisphere
+// sampling and rejection-free mappings of unit square samples
+//
+// random     - independent uniform random points (white noise)
+// stratified - jittered grid points
+// halton     - halton sequence (bases 2,3) w/ random toroidal shift
+// sobol      - owen scrambled sobol sequence
+// bluenoise  - precomputed progressive blue noise point table w/ random
+//              toroidal shift
+//
+
+#pragma once
+#include "Random.hh"
+#include "Types.hh"
+#include <string_view>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+
+// **** Types ****
+enum SamplerType {
+  SAMPLER_RANDOM, SAMPLER_STRATIFIED, SAMPLER_HALTON, SAMPLER_SOBOL,
+  SAMPLER_BLUENOISE
+};
+
+enum SampleDim {
+  DIM_JITTER, DIM_APERTURE, DIM_HEMISPHERE, DIM_LIGHT
+};
+
+
+class Sampler
+{
+ public:
+  Sampler() = default;
+  explicit Sampler(SamplerType t) : _type{t} { }
+
+  // Member Functions
+  [[nodiscard]] SamplerType type() const { return _type; }
+  void setPixelSeed(uint64_t seed) { _pixelSeed = seed; }
+
+  [[nodiscard]] Vec2 operator()(PCG32& g, SampleDim dim, int index,
+                                int count, int stream);
+    // returns sample 'index' of 'count' samples in the [0,1) unit square
+    // ('stream' value decorrelates multiple sample sets in the same pixel)
+
+ private:
+  SamplerType _type = SAMPLER_RANDOM;
+  uint64_t _pixelSeed = 0;
+
+  [[nodiscard]] uint64_t streamSeed(SampleDim dim, int stream) const;
+  [[nodiscard]] Vec2 halton(uint32_t index, uint64_t seed) const;
+  [[nodiscard]] Vec2 sobol(uint32_t index, uint64_t seed) const;
+  [[nodiscard]] Vec2 blueNoise(uint32_t index, uint64_t seed) const;
+};
+
+
+// **** Functions ****
+[[nodiscard]] bool findSamplerType(std::string_view name, SamplerType& type);
+
+[[nodiscard]] inline Vec2 concentricDisk(const Vec2& u)
+{
+  // Shirley-Chiu concentric mapping of unit square to unit disk
+  const Flt x = (u.x * 2.0) - 1.0;
+  const Flt y = (u.y * 2.0) - 1.0;
+  if (x == 0.0 && y == 0.0) { return {0,0}; }
+
+  Flt r, theta;
+  if (Abs(x) > Abs(y)) {
+    r = x; theta = (PI * .25) * (y / x);
+  } else {
+    r = y; theta = (PI * .5) - ((PI * .25) * (x / y));
+  }
+  return {r * std::cos(theta), r * std::sin(theta)};
+}
+
+inline void orthonormalBasis(const Vec3& normal, Vec3& t1, Vec3& t2)
+{
+  // tangent vectors for unit normal (Duff et al. 2017)
+  const Flt sgn = std::copysign(1.0, normal.z);
+  const Flt a = -1.0 / (sgn + normal.z);
+  const Flt b = normal.x * normal.y * a;
+  t1 = {1.0 + (sgn * normal.x * normal.x * a), sgn * b, -sgn * normal.x};
+  t2 = {b, sgn + (normal.y * normal.y * a), -normal.y};
+}
+
+[[nodiscard]] inline Vec3 uniformHemisphere(const Vec2& u, const Vec3& normal)
+{
+  // uniform direction in hemisphere around normal
+  const Flt z = u.x;
+  const Flt r = std::sqrt(std::max(0.0, 1.0 - (z * z)));
+  const Flt phi = 2.0 * PI * u.y;
+
+  Vec3 t1{INIT_NONE}, t2{INIT_NONE};
+  orthonormalBasis(normal, t1, t2);
+  return (t1 * (r * std::cos(phi))) + (t2 * (r * std::sin(phi)))
+    + (normal * z);
+}
+
+[[nodiscard]] inline Vec3 cosineHemisphere(const Vec2& u, const Vec3& normal)
+{
+  // cosine weighted direction in hemisphere around normal
+  // (Malley's method - unit disk point projected up to hemisphere)
+  const Vec2 d = concentricDisk(u);
+  const Flt z = std::sqrt(std::max(0.0, 1.0 - (d.x * d.x) - (d.y * d.y)));
+
+  Vec3 t1{INIT_NONE}, t2{INIT_NONE};
+  orthonormalBasis(normal, t1, t2);
+  return (t1 * d.x) + (t2 * d.y) + (normal * z);
+}
+
+
+// **** Inline Implementation ****
+inline Vec2 Sampler::operator()(
+  PCG32& g, SampleDim dim, int index, int count, int stream)
+{
+  switch (_type) {
+    default:
+    case SAMPLER_RANDOM:
+      // area light & hemisphere samples are always at least stratified
+      if (dim != DIM_LIGHT && dim != DIM_HEMISPHERE) {
+        return {g.uniform(), g.uniform()}; }
+      [[fallthrough]];
+
+    case SAMPLER_STRATIFIED: {
+      const int nx = std::max(int(std::ceil(std::sqrt(Flt(count)))), 1);
+      const int ny = (count + nx - 1) / nx;
+      const int cx = index % nx, cy = (index / nx) % ny;
+      return {(Flt(cx) + g.uniform()) / Flt(nx),
+              (Flt(cy) + g.uniform()) / Flt(ny)};
+    }
+
+    case SAMPLER_HALTON:
+      return halton(uint32_t(index), streamSeed(dim, stream));
+
+    case SAMPLER_SOBOL:
+      return sobol(uint32_t(index), streamSeed(dim, stream));
+
+    case SAMPLER_BLUENOISE:
+      return blueNoise(uint32_t(index), streamSeed(dim, stream));
+  }
+}
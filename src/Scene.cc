@@ -13,9 +13,29 @@
 #include "JobState.hh"
 #include "Color.hh"
 #include "Print.hh"
+#include <algorithm>
 #include <cassert>
 
 
+// **** Helper Functions ****
+using VisibleLeaf = std::pair<ObjectPtr,unsigned>;
+
+static void addLeaves(std::span<const ObjectPtr> o_list, unsigned vis,
+                      std::vector<VisibleLeaf>& leaves)
+{
+  // group visibility applies to all group members
+  for (auto& ob : o_list) {
+    const unsigned v = vis & ob->visibility();
+    if (dynamic_cast<const Primitive*>(ob.get())) {
+      leaves.emplace_back(ob, v);
+    } else {
+      // assume group - process children
+      addLeaves(ob->children(), v, leaves);
+    }
+  }
+}
+
+
 // **** Scene Class ****
 Scene::~Scene() = default;
 
@@ -41,17 +61,32 @@ void Scene::clear()
   sample_y = 1;
   jitter = 0.0;
   samples = 1;
+  sampler = SAMPLER_RANDOM;
+  seed = 0;
+  filter = FILTER_BOX;
+  filter_radius = 0;
+  texture_filter = false;
   shadow = true;
   reflect = true;
   transmit = true;
   max_ray_depth = 99;
-  min_ray_value = VERY_SMALL;
+  min_ray_value = 1.0 / 512.0;
+  roulette_depth = 0;
+  light_samples = 0;
   ray_moveout = .0001;
+  tile_size = 16;
+  msaa = false;
+  wavefront = false;
+  denoise = 0;
+  split_budget = .25;
 
   // object clear
   _objects.clear();
   _optObjects.clear();
+  _reflectObjects.clear();
+  _shadowObjects.clear();
   _lights.clear();
+  _lightIndex.clear();
   _shaders.clear();
 
   bound_count = 0;
@@ -59,6 +94,8 @@ void Scene::clear()
   csg_count = 0;
   object_count = 0;
   shader_count = 0;
+  footprint_shader_count = 0;
+  hidden_count = 0;
 }
 
 int Scene::addObject(const ObjectPtr& ob)
@@ -147,10 +184,58 @@ int Scene::init()
   }
 
   // setup bounding boxes
-  bound_count = makeBoundList(*this, _objects, _optObjects);
+  std::vector<VisibleLeaf> leaves;
+  addLeaves(_objects, VIS_ALL, leaves);
+  hidden_count = int(std::count_if(
+    leaves.begin(), leaves.end(),
+    [](const VisibleLeaf& l){ return l.second != VIS_ALL; }));
+
+  if (hidden_count == 0) {
+    bound_count = makeBoundList(*this, _objects, _optObjects);
+    _reflectObjects = _optObjects;
+    _shadowObjects = _optObjects;
+  } else {
+    // separate bound list for each ray type with different visible objects
+    // (shadow rays skip objects like ground planes that can't block light)
+    const auto sameVisible = [&leaves](unsigned v1, unsigned v2) {
+      return std::all_of(leaves.begin(), leaves.end(),
+                         [v1,v2](const VisibleLeaf& l){
+                           return !(l.second & v1) == !(l.second & v2); });
+    };
+
+    const auto makeVisibleList = [this,&leaves](
+      unsigned vis, std::vector<ObjectPtr>& bound_list,
+      std::string_view label) {
+      std::vector<ObjectPtr> visible;
+      for (auto& [ob,v] : leaves) { if (v & vis) { visible.push_back(ob); } }
+      bound_list.clear();
+      return makeBoundList(*this, visible, bound_list, label);
+    };
+
+    bound_count = makeVisibleList(VIS_CAMERA, _optObjects, "camera");
+    if (sameVisible(VIS_REFLECT, VIS_CAMERA)) {
+      _reflectObjects = _optObjects;
+    } else {
+      makeVisibleList(VIS_REFLECT, _reflectObjects, "reflect");
+    }
+
+    if (sameVisible(VIS_SHADOW, VIS_CAMERA)) {
+      _shadowObjects = _optObjects;
+    } else if (sameVisible(VIS_SHADOW, VIS_REFLECT)) {
+      _shadowObjects = _reflectObjects;
+    } else {
+      makeVisibleList(VIS_SHADOW, _shadowObjects, "shadow");
+    }
+  }
+
+  // setup light index
+  // (after objects so lights in groups have their final position)
+  _lightIndex.build(_lights);
+  for (auto& lt : _lights) { lt->initShadows(*this); }
 
   // init shaders
   shader_count = 0;
+  footprint_shader_count = 0;
   for (auto& sh : _shaders) {
     if (initShader(*sh, nullptr)) {
       println("Error initializing shaders");
@@ -158,6 +243,14 @@ int Scene::init()
     }
   }
 
+  // estimate light power for light sampling
+  JobState js;
+  int index = 0;
+  for (auto& lt : _lights) {
+    lt->setIndex(index++);
+    lt->initPower(js, *this);
+  }
+
   // everything okay
   return 0;
 }
@@ -196,54 +289,188 @@ int Scene::initShader(Shader& sh, const Transform* tr)
   if (trans) { trans->init(tr); tr = trans; }
 
   ++shader_count;
+  if (sh.usesFootprint()) { ++footprint_shader_count; }
   return sh.init(*this, tr);
 }
 
 Color Scene::traceRay(JobState& js, const Ray& r) const
+{
+  HitInfo hit;
+  return findHit(js, r, hit)
+    ? shadeHit(js, r, hit) : shadeBackground(js, r);
+}
+
+template<class ObjectList>
+static bool findFirstHit(JobState& js, const Ray& r, HitInfo& hit,
+                         const ObjectList& objects)
 {
   StatInfo& si = js.stats;
   ++si.rays.tried;
 
   HitList hit_list{js.cache, si, false};
-  for (auto& ob : _optObjects) { ob->intersect(r, hit_list); }
+  for (auto& ob : objects) { ob->intersect(r, hit_list); }
 
-  const HitInfo* hit = hit_list.firstHit();
-  if (!hit) {
-    // hit background
-    const EvaluatedHit eh{
-      {}, {}, {(r.dir.z > 0.0) ? r.dir.x : -r.dir.x, r.dir.y, 0.0}, 0};
-    return background->evaluate(js, *this, r, eh);
-  }
+  const HitInfo* h = hit_list.firstHit();
+  if (!h) { return false; }
 
   ++si.rays.hit;
+  hit = *h;
+  hit.next = nullptr;
+  return true;
+}
 
-  const Primitive* obj = hit->object;
+bool Scene::findHit(JobState& js, const Ray& r, HitInfo& hit,
+                    std::span<const ObjectPtr> objects) const
+{
+  return findFirstHit(js, r, hit, objects);
+}
+
+bool Scene::findHit(JobState& js, const Ray& r, HitInfo& hit,
+                    std::span<const Object* const> objects) const
+{
+  return findFirstHit(js, r, hit, objects);
+}
+
+Color Scene::shadeHit(JobState& js, const Ray& r, const HitInfo& hit) const
+{
+  const Primitive* obj = hit.object;
   const Shader* sh = obj->shader().get();
   if (!sh) { sh = _defaultObj.get(); }
 
   EvaluatedHit eh{
-    CalcHitPoint(r.base, r.dir, hit->distance),
-    obj->normal(r, *hit),
-    hit->local_pt,
-    hit->side
+    CalcHitPoint(r.base, r.dir, hit.distance),
+    obj->normal(r, hit),
+    hit.local_pt,
+    hit.side
   };
-  if (dotProduct(r.dir, eh.normal) > 0.0) { eh.normal = -eh.normal; }
+
+  const bool flip = dotProduct(r.dir, eh.normal) > 0.0;
+  if (flip) { eh.normal = -eh.normal; }
+
+  const Flt dn = dotProduct(r.dir, eh.normal);
+  if (r.diff && dn < -VERY_SMALL) {
+    // transfer ray differentials to hit point on surface tangent plane
+    const auto transfer = [&](const Vec3& dP, const Vec3& dD) {
+      const Vec3 dp = dP + (dD * hit.distance);
+      return dp - (r.dir * (dotProduct(dp, eh.normal) / dn));
+    };
+    eh.dPdx = transfer(r.diff->dPdx, r.diff->dDdx);
+    eh.dPdy = transfer(r.diff->dPdy, r.diff->dDdy);
+
+    const Transform& tr = obj->transform();
+    eh.dmapdx = tr.vectorGlobalToLocal(eh.dPdx);
+    eh.dmapdy = tr.vectorGlobalToLocal(eh.dPdy);
+
+    // normal change from neighboring surface points
+    // (zero for flat surfaces, needed for reflection footprint on curves)
+    const auto normalAt = [&](const Vec3& dmap) {
+      HitInfo h = hit;
+      h.local_pt += dmap;
+      const Vec3 n = obj->normal(r, h);
+      return (flip ? -n : n) - eh.normal;
+    };
+    eh.dNdx = normalAt(eh.dmapdx);
+    eh.dNdy = normalAt(eh.dmapdy);
+    eh.differentials = true;
+  }
 
   return sh->evaluate(js, *this, r, eh);
 }
 
-bool Scene::castShadowRay(JobState& js, const Ray& r) const
+Color Scene::shadeBackground(JobState& js, const Ray& r) const
+{
+  const Flt sx = (r.dir.z > 0.0) ? 1.0 : -1.0;
+  EvaluatedHit eh{{}, {}, {r.dir.x * sx, r.dir.y, 0.0}, 0};
+  if (r.diff) {
+    eh.dmapdx = {r.diff->dDdx.x * sx, r.diff->dDdx.y, 0.0};
+    eh.dmapdy = {r.diff->dDdy.x * sx, r.diff->dDdy.y, 0.0};
+    eh.differentials = true;
+  }
+  return background->evaluate(js, *this, r, eh);
+}
+
+Flt Scene::hitDistance(JobState& js, const Ray& r) const
 {
   StatInfo& si = js.stats;
   ++si.shadow_rays.tried;
 
+  const uint64_t tried = si.objectsTried();
   HitList hit_list{js.cache, si, false};
-  for (auto& ob : _optObjects) { ob->intersect(r, hit_list); }
+  for (auto& ob : _shadowObjects) { ob->intersect(r, hit_list); }
+  si.shadow_objects += si.objectsTried() - tried;
 
   const HitInfo* hit = hit_list.firstHit();
-  if (!hit) { return false; }
+  if (!hit) { return VERY_LARGE; }
 
   ++si.shadow_rays.hit;
+  return hit->distance;
+}
+
+std::span<const Light* const> Scene::lightsAt(
+  JobState& js, const Vec3& pt) const
+{
+  js.lightList.clear();
+  _lightIndex.query(pt, js.lightList);
+  return js.lightList;
+}
+
+bool Scene::lightBlocked(
+  JobState& js, const Ray& r, int light, const ShadowGrid* grid) const
+{
+  if (!js.wavefront) { return castShadowRay(js, r, light, grid); }
+
+  js.queueShadow(r, grid, light);
+  return false;
+}
+
+bool Scene::castShadowRay(
+  JobState& js, const Ray& r, int light, const ShadowGrid* grid) const
+{
+  StatInfo& si = js.stats;
+  ++si.shadow_rays.tried;
+  const uint64_t tried = si.objectsTried();
+
+  const Object** lastOccluder =
+    (light >= 0 && light < int(js.shadowCache.size()))
+    ? &js.shadowCache[std::size_t(light)] : nullptr;
+
+  if (lastOccluder && *lastOccluder) {
+    // try last object that blocked this light first
+    ++si.shadow_cache.tried;
+    HitList hit_list{js.cache, si, false};
+    (*lastOccluder)->intersect(r, hit_list);
+    if (hit_list.firstHit()) {
+      ++si.shadow_cache.hit;
+      ++si.shadow_rays.hit;
+      si.shadow_objects += si.objectsTried() - tried;
+      return true;
+    }
+  }
+
+  HitList hit_list{js.cache, si, false};
+  if (grid && !grid->empty()) {
+    grid->intersect(r, hit_list);
+  } else {
+    // any hit blocks shadow ray so stop at first object hit
+    for (auto& ob : _shadowObjects) {
+      if (ob->occludes(r, hit_list)) { break; }
+    }
+  }
+  si.shadow_objects += si.objectsTried() - tried;
+
+  const HitInfo* hit = hit_list.firstHit();
+  if (!hit) {
+    // only keep occluder while shadow rays for light are blocked
+    if (lastOccluder) { *lastOccluder = nullptr; }
+    return false;
+  }
+
+  ++si.shadow_rays.hit;
+  if (lastOccluder) {
+    // cache whole CSG object if hit is part of one
+    *lastOccluder = hit->parent ? hit->parent : hit->object;
+  }
+
   // transparency not supported
   return true;
 }
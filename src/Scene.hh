@@ -8,9 +8,13 @@
 #pragma once
 #include "ObjectPtr.hh"
 #include "LightPtr.hh"
+#include "LightIndex.hh"
+#include "ShadowGrid.hh"
 #include "ShaderPtr.hh"
 #include "SceneItem.hh"
 #include "HitCostInfo.hh"
+#include "Sampler.hh"
+#include "Filter.hh"
 #include "Types.hh"
 #include <vector>
 #include <span>
@@ -39,22 +43,40 @@ class Scene
   int  sample_x, sample_y;  // sub-pixel grid size
   Flt  jitter;              // x/y jitter amount for a sub-pixel
   int  samples;             // sample count for a sub-pixel if jittering
+  SamplerType sampler;      // sample sequence for jitter/aperture/hemisphere
+  int  seed;                // random sequence seed (vary for multiple passes)
+  FilterType filter;        // pixel reconstruction filter
+  Flt  filter_radius;       // filter radius in pixels (0 for filter default)
+  bool texture_filter;      // filter patterns by ray footprint (opt-in)
 
   // secondary ray settings
   bool shadow, reflect, transmit;
   int  max_ray_depth;
-  Flt  min_ray_value;
+  Flt  min_ray_value;       // secondary rays with less weight are culled
+  int  roulette_depth;      // russian roulette ray depth (0 to disable)
+  int  light_samples;       // lights sampled per shading point (0 for all)
   Flt  ray_moveout;
 
+  // render task settings
+  int  tile_size;           // width/height of square render tiles
+  bool msaa;                // shade each object once per pixel (MSAA style)
+  bool wavefront;           // render tiles breadth first with ray queues
+                            // (not used with denoise, splat filter or msaa)
+  int  denoise;             // denoise filter passes after render (0 for none)
+
   // scene inventory count
   int bound_count;
   int csg_count;
   int group_count;
   int object_count;
   int shader_count;
+  int footprint_shader_count;  // shaders using ray differentials
+  int hidden_count;            // objects hidden from some ray types
 
   // intersection cost estimate
   HitCostInfo hitCosts;
+  Flt  split_budget;        // extra object references for spatial splits
+                            // (fraction of object count - 0 to disable)
 
 
   Scene() { clear(); }
@@ -72,14 +94,51 @@ class Scene
   int initShader(Shader& sh, const Transform* tr);
 
   [[nodiscard]] Color traceRay(JobState& js, const Ray& r) const;
-  [[nodiscard]] bool castShadowRay(JobState& js, const Ray& r) const;
+
+  // traceRay() steps
+  [[nodiscard]] bool findHit(JobState& js, const Ray& r, HitInfo& hit) const {
+    return findHit(js, r, hit, _reflectObjects); }
+    // (secondary rays - primary rays pass camera visible objects)
+  [[nodiscard]] bool findHit(JobState& js, const Ray& r, HitInfo& hit,
+                             std::span<const ObjectPtr> objects) const;
+  [[nodiscard]] bool findHit(JobState& js, const Ray& r, HitInfo& hit,
+                             std::span<const Object* const> objects) const;
+    // (objects replaces scene bound list - used for culled primary rays)
+  [[nodiscard]] Color shadeHit(
+    JobState& js, const Ray& r, const HitInfo& hit) const;
+  [[nodiscard]] Color shadeBackground(JobState& js, const Ray& r) const;
+  [[nodiscard]] Flt hitDistance(JobState& js, const Ray& r) const;
+    // distance to nearest object hit in ray range (VERY_LARGE if none)
+
+  [[nodiscard]] bool castShadowRay(
+    JobState& js, const Ray& r, int light = -1,
+    const ShadowGrid* grid = nullptr) const;
+    // (light index enables per-light occluder cache,
+    //  grid replaces scene objects for directional lights)
+
+  [[nodiscard]] bool lightBlocked(
+    JobState& js, const Ray& r, int light,
+    const ShadowGrid* grid = nullptr) const;
+    // single shadow ray that decides if a light reaches a point
+    // (queued for a wavefront render & false is returned - caller must
+    //  pass its light result to JobState::setShadowValue())
 
   [[nodiscard]] std::span<const ObjectPtr> objects() const {
     return _objects; }
   [[nodiscard]] std::span<const ObjectPtr> optObjects() const {
     return _optObjects; }
+  [[nodiscard]] std::span<const ObjectPtr> reflectObjects() const {
+    return _reflectObjects; }
+  [[nodiscard]] std::span<const ObjectPtr> shadowObjects() const {
+    return _shadowObjects; }
   [[nodiscard]] std::span<const LightPtr> lights() const {
     return _lights; }
+  [[nodiscard]] const LightIndex& lightIndex() const { return _lightIndex; }
+
+  [[nodiscard]] std::span<const Light* const> lightsAt(
+    JobState& js, const Vec3& pt) const;
+    // lights that can affect pt
+    // (result is only valid until the next lightsAt() call with js)
 
   [[nodiscard]] int samplesPerPixel() const {
     const bool multiSample = isPositive(jitter) || isPositive(aperture);
@@ -92,9 +151,14 @@ class Scene
     // Complete list of objects (including Groups but not Bounds)
 
   std::vector<ObjectPtr> _optObjects;
-    // bounding box optimized objects
+    // bounding box optimized objects (visible to camera rays)
+
+  std::vector<ObjectPtr> _reflectObjects, _shadowObjects;
+    // bounding box optimized objects for secondary & shadow rays
+    // (copies of _optObjects unless some objects are hidden from them)
 
   std::vector<LightPtr> _lights;
+  LightIndex _lightIndex;
 
   std::vector<ShaderPtr> _shaders;
     // all top-level shader objects (for initialization)
@@ -23,6 +23,12 @@ enum SceneItemFlag {
   FLAG_BORDER,
 };
 
+enum RayVisibility : unsigned {
+  // ray types that can hit an object
+  VIS_CAMERA = 1, VIS_REFLECT = 2, VIS_SHADOW = 4,
+  VIS_ALL = VIS_CAMERA | VIS_REFLECT | VIS_SHADOW
+};
+
 
 // SceneItem class definition
 //  provides interface for parser to modify scene elements
@@ -45,6 +51,7 @@ class SceneItem
   virtual int setSides(int v) { return -1; }
   virtual int setSpin(Flt v) { return -1; }
   virtual int setValue(Flt v) { return -1; }
+  virtual int setVisible(RayVisibility v, bool val) { return -1; }
 
   virtual int addObject(const ObjectPtr& ob) { return -1; }
   virtual int addLight(const LightPtr& lt) { return -1; }
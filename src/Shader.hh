@@ -22,6 +22,14 @@ struct EvaluatedHit {
   Vec3 normal{INIT_NONE};
   Vec3 map{INIT_NONE};
   int side;
+
+  // hit footprint from ray differentials
+  // (change in global point, normal & map value for a one sample step
+  //  across the image in x & y, only valid if 'differentials' is set)
+  Vec3 dPdx{0,0,0}, dPdy{0,0,0};
+  Vec3 dNdx{0,0,0}, dNdy{0,0,0};
+  Vec3 dmapdx{0,0,0}, dmapdy{0,0,0};
+  bool differentials = false;
 };
 
 class Shader : public SceneItem
@@ -31,6 +39,9 @@ class Shader : public SceneItem
   virtual int init(Scene& s, const Transform* tr) { return 0; }
   virtual Color evaluate(JobState& js, const Scene& s, const Ray& r,
                          const EvaluatedHit& eh) const = 0;
+  [[nodiscard]] virtual bool usesFootprint() const { return false; }
+    // true if shader filters its result by the hit footprint
+    // (ray differentials are only tracked if a scene shader needs them)
 };
 
 
@@ -0,0 +1,153 @@
+//
+// ShadowGrid.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "ShadowGrid.hh"
+#include "Object.hh"
+#include "CSG.hh"
+#include "BBox.hh"
+#include "Ray.hh"
+#include "Intersect.hh"
+#include "Sampler.hh"
+#include <unordered_set>
+#include <algorithm>
+#include <cmath>
+
+
+// **** Helper Functions ****
+static void addLeaves(
+  std::span<const ObjectPtr> o_list, std::vector<const Object*>& leaves)
+{
+  for (auto& ob : o_list) {
+    if (dynamic_cast<const Union*>(ob.get())) {
+      // any union member hit blocks a shadow ray
+      addLeaves(ob->children(), leaves);
+    } else if (dynamic_cast<const Primitive*>(ob.get())) {
+      leaves.push_back(ob.get());
+    } else {
+      // assume group - process children
+      addLeaves(ob->children(), leaves);
+    }
+  }
+}
+
+
+// **** ShadowGrid Class ****
+void ShadowGrid::clear()
+{
+  _items.clear();
+  _cellStart.clear();
+  _cellItems.clear();
+  _nx = _ny = 0;
+}
+
+void ShadowGrid::build(std::span<const ObjectPtr> objects, const Vec3& dir)
+{
+  clear();
+  _dir = dir;
+  orthonormalBasis(dir, _u, _v);
+
+  std::vector<const Object*> leaves;
+  addLeaves(objects, leaves);
+
+  // objects split across several bounds are reached once per piece
+  std::unordered_set<const Object*> added;
+  std::erase_if(leaves, [&added](const Object* ob) {
+    return !added.insert(ob).second; });
+  if (leaves.empty()) { return; }
+
+  // project object bounds onto plane perpendicular to dir
+  struct Rect { Vec2 lo, hi; };
+  std::vector<Rect> rects;
+  rects.reserve(leaves.size());
+  _items.reserve(leaves.size());
+
+  Vec2 gmin{VERY_LARGE, VERY_LARGE}, gmax{-VERY_LARGE, -VERY_LARGE};
+  for (const Object* ob : leaves) {
+    const BBox b = ob->bound(nullptr);
+    Rect rc{{VERY_LARGE, VERY_LARGE}, {-VERY_LARGE, -VERY_LARGE}};
+    Flt maxDepth = -VERY_LARGE;
+    for (int i = 0; i < 8; ++i) {
+      const Vec3 c{(i & 1) ? b.pmax.x : b.pmin.x,
+                   (i & 2) ? b.pmax.y : b.pmin.y,
+                   (i & 4) ? b.pmax.z : b.pmin.z};
+      const Flt pu = dotProduct(c, _u), pv = dotProduct(c, _v);
+      rc.lo = {std::min(rc.lo.x, pu), std::min(rc.lo.y, pv)};
+      rc.hi = {std::max(rc.hi.x, pu), std::max(rc.hi.y, pv)};
+      maxDepth = std::max(maxDepth, dotProduct(c, _dir));
+    }
+
+    _items.push_back({ob, maxDepth});
+    rects.push_back(rc);
+    gmin = {std::min(gmin.x, rc.lo.x), std::min(gmin.y, rc.lo.y)};
+    gmax = {std::max(gmax.x, rc.hi.x), std::max(gmax.y, rc.hi.y)};
+  }
+
+  // grid resolution - about 2 cells per object (max 512x512)
+  constexpr int MAX_RES = 512;
+  const Flt w = std::max(gmax.x - gmin.x, VERY_SMALL);
+  const Flt h = std::max(gmax.y - gmin.y, VERY_SMALL);
+  const Flt cellSize = std::max(
+    std::sqrt((w * h) / Flt(_items.size() * 2)), std::max(w, h) / MAX_RES);
+  _min = gmin;
+  _cellInv = 1.0 / cellSize;
+  _nx = std::clamp(int(std::ceil(w * _cellInv)), 1, MAX_RES);
+  _ny = std::clamp(int(std::ceil(h * _cellInv)), 1, MAX_RES);
+
+  const auto cellX = [this](Flt x) {
+    return std::clamp(int((x - _min.x) * _cellInv), 0, _nx - 1); };
+  const auto cellY = [this](Flt y) {
+    return std::clamp(int((y - _min.y) * _cellInv), 0, _ny - 1); };
+
+  // bin items into cells
+  _cellStart.assign(std::size_t(_nx * _ny) + 1, 0);
+  for (const Rect& rc : rects) {
+    for (int y = cellY(rc.lo.y); y <= cellY(rc.hi.y); ++y) {
+      for (int x = cellX(rc.lo.x); x <= cellX(rc.hi.x); ++x) {
+        ++_cellStart[std::size_t((y * _nx) + x + 1)];
+      }
+    }
+  }
+
+  for (std::size_t i = 1; i < _cellStart.size(); ++i) {
+    _cellStart[i] += _cellStart[i-1];
+  }
+
+  _cellItems.resize(std::size_t(_cellStart.back()));
+  std::vector<int> next{_cellStart.begin(), _cellStart.end() - 1};
+  for (std::size_t i = 0; i < rects.size(); ++i) {
+    const Rect& rc = rects[i];
+    for (int y = cellY(rc.lo.y); y <= cellY(rc.hi.y); ++y) {
+      for (int x = cellX(rc.lo.x); x <= cellX(rc.hi.x); ++x) {
+        const auto c = std::size_t((y * _nx) + x);
+        _cellItems[std::size_t(next[c]++)] = int(i);
+      }
+    }
+  }
+}
+
+int ShadowGrid::intersect(const Ray& r, HitList& hl) const
+{
+  // all points along ray project to the same cell
+  const Flt x = (dotProduct(r.base, _u) - _min.x) * _cellInv;
+  const Flt y = (dotProduct(r.base, _v) - _min.y) * _cellInv;
+  if (x < 0.0 || y < 0.0) { return 0; }
+
+  const int cx = int(x), cy = int(y);
+  if (cx >= _nx || cy >= _ny) { return 0; }
+
+  // objects entirely behind ray start can't block it
+  const Flt depth = dotProduct(r.base, _dir) + r.min_length;
+
+  const auto c = std::size_t((cy * _nx) + cx);
+  for (int i = _cellStart[c]; i < _cellStart[c+1]; ++i) {
+    const Item& item = _items[std::size_t(_cellItems[std::size_t(i)])];
+    if (item.maxDepth < depth) { continue; }
+
+    item.object->intersect(r, hl);
+    if (!hl.empty()) { return hl.size(); }
+  }
+
+  return 0;
+}
@@ -0,0 +1,44 @@
+//
+// ShadowGrid.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// 2D grid of object bounds projected along a fixed direction for
+// accelerating parallel shadow rays (Sun lights)
+//
+
+#pragma once
+#include "ObjectPtr.hh"
+#include "Types.hh"
+#include <vector>
+#include <span>
+
+
+// **** Types ****
+class ShadowGrid
+{
+ public:
+  // Member Functions
+  void clear();
+  void build(std::span<const ObjectPtr> objects, const Vec3& dir);
+    // dir is unit direction of all shadow rays
+
+  int intersect(const Ray& r, HitList& hl) const;
+    // stops at first hit found (result only valid for shadow queries)
+
+  [[nodiscard]] bool empty() const { return _items.empty(); }
+  [[nodiscard]] int cellCount() const { return _nx * _ny; }
+
+ private:
+  struct Item {
+    const Object* object;
+    Flt maxDepth;  // furthest extent along dir
+  };
+
+  std::vector<Item> _items;
+  std::vector<int> _cellStart;  // nx*ny+1 offsets into _cellItems
+  std::vector<int> _cellItems;
+  Vec3 _dir{INIT_NONE}, _u{INIT_NONE}, _v{INIT_NONE};
+  Vec2 _min{INIT_NONE};
+  Flt _cellInv = 0;
+  int _nx = 0, _ny = 0;
+};
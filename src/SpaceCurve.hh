@@ -0,0 +1,47 @@
+//
+// SpaceCurve.hh
+// Copyright (C) 2026 Richard Bradley
+//
+// space filling curve functions for cache friendly 2D traversal order
+//
+
+#pragma once
+#include <cstdint>
+
+
+// **** Functions ****
+[[nodiscard]] constexpr uint32_t mortonCompact(uint32_t x)
+{
+  // extract even bits of x into lower 16 bits
+  x &= 0x55555555;
+  x = (x | (x >> 1)) & 0x33333333;
+  x = (x | (x >> 2)) & 0x0f0f0f0f;
+  x = (x | (x >> 4)) & 0x00ff00ff;
+  x = (x | (x >> 8)) & 0x0000ffff;
+  return x;
+}
+
+[[nodiscard]] constexpr uint32_t mortonX(uint32_t code) {
+  return mortonCompact(code); }
+[[nodiscard]] constexpr uint32_t mortonY(uint32_t code) {
+  return mortonCompact(code >> 1); }
+
+[[nodiscard]] constexpr uint32_t hilbertIndex(
+  uint32_t n, uint32_t x, uint32_t y)
+{
+  // distance of (x,y) along hilbert curve filling a n x n grid
+  // (n must be a power of 2)
+  uint32_t d = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    const uint32_t rx = (x & s) ? 1 : 0;
+    const uint32_t ry = (y & s) ? 1 : 0;
+    d += s * s * ((3 * rx) ^ ry);
+
+    // rotate quadrant
+    if (ry == 0) {
+      if (rx == 1) { x = n - 1 - x; y = n - 1 - y; }
+      const uint32_t t = x; x = y; y = t;
+    }
+  }
+  return d;
+}
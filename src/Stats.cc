@@ -11,6 +11,8 @@ StatInfo& StatInfo::operator+=(const StatInfo& s)
 {
   rays          += s.rays;
   shadow_rays   += s.shadow_rays;
+  shadow_cache  += s.shadow_cache;
+  ao_cache      += s.ao_cache;
   bound         += s.bound;
   disc          += s.disc;
   cone          += s.cone;
@@ -21,5 +23,7 @@ StatInfo& StatInfo::operator+=(const StatInfo& s)
   prism         += s.prism;
   sphere        += s.sphere;
   torus         += s.torus;
+  shadow_objects += s.shadow_objects;
+  csg_culled    += s.csg_culled;
   return *this;
 }
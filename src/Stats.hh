@@ -22,6 +22,8 @@ class StatInfo
 
   RayStats rays;
   RayStats shadow_rays;
+  RayStats shadow_cache;
+  RayStats ao_cache;
   RayStats bound;
   RayStats disc;
   RayStats cone;
@@ -32,6 +34,8 @@ class StatInfo
   RayStats prism;
   RayStats sphere;
   RayStats torus;
+  uint64_t shadow_objects = 0;  // object tests for shadow rays
+  uint64_t csg_culled = 0;      // CSG child tests skipped by box spans
 
   // Member Functions
   StatInfo& operator+=(const StatInfo& stats);
@@ -32,6 +32,7 @@ class Transform
   [[nodiscard]] inline Vec2 pointLocalToGlobalXY(const Vec3& pos) const;
   [[nodiscard]] inline Flt pointLocalToGlobalX(const Vec3& pos) const;
   [[nodiscard]] inline Vec3 vectorLocalToGlobal(const Vec3& dir) const;
+  [[nodiscard]] inline Vec3 vectorGlobalToLocal(const Vec3& dir) const;
     // TODO: add time parameter to support motion blur/animation
 
   [[nodiscard]] inline Vec3 rayLocalDir(const Ray& r) const;
@@ -71,6 +72,11 @@ Vec3 Transform::vectorLocalToGlobal(const Vec3& dir) const
   return multVector(dir, _final);
 }
 
+Vec3 Transform::vectorGlobalToLocal(const Vec3& dir) const
+{
+  return multVector(dir, _finalInv);
+}
+
 Vec3 Transform::rayLocalDir(const Ray& r) const
 {
   return multVector(r.dir, _finalInv);
@@ -21,6 +21,7 @@ class HitCostInfo;
 class HitInfo;
 class HitList;
 struct JobState;
+class Object;
 class Primitive;
 class Ray;
 class Scene;
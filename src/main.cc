@@ -36,6 +36,14 @@ int shellInfo(const Scene& s, const FrameBuffer& fb)
   println("    VUP vector:\t", s.vup);
   println(" Max ray depth:\t", s.max_ray_depth);
   println(" Min ray value:\t", s.min_ray_value);
+  println("Roulette depth:\t", s.roulette_depth);
+  println(" Light samples:\t", s.light_samples);
+  println("Denoise passes:\t", s.denoise);
+  if (isPositive(s.filter_radius)) {
+    println("  Pixel filter:\t", filterName(s.filter), " ", s.filter_radius);
+  } else {
+    println("  Pixel filter:\t", filterName(s.filter));
+  }
 
   print("Light List:");
   for (auto& lt : s.lights()) { println("  ", lt->desc()); }
@@ -131,9 +139,17 @@ int shellRender(Renderer& ren, Scene& s, FrameBuffer& fb)
     ren.stopJobs();
   }
 
+  // resolve & filter render result
+  // (filter time is included in rendering time)
+  ren.finish();
+
   const auto t2 = usecTime();
   println("\rTotal Time: ", secDiff(t0,t2), "  (setup ", secDiff(t0,t1),
           ", rendering ", secDiff(t1,t2), ")");
+
+  const StatInfo& st = ren.stats();
+  const double rays = double(st.rays.tried + st.shadow_rays.tried);
+  println("Rays/sec: ", uint64_t(rays / secDiff(t1,t2)));
   return 0;
 }
 
@@ -184,12 +200,34 @@ void shellStats(const Renderer& ren, const Scene& s)
   println("        Rays Hit  ", st.rays.hit);
   println("Shadow Rays Cast  ", st.shadow_rays.tried);
   println(" Shadow Rays Hit  ", st.shadow_rays.hit);
+  if (st.shadow_rays.tried > 0) {
+    println(" Shadow Objs/Ray  ", double(st.shadow_objects)
+            / double(st.shadow_rays.tried));
+  }
+  println("Shadow Cache Try  ", st.shadow_cache.tried);
+  println("Shadow Cache Hit  ", st.shadow_cache.hit);
+  if (st.shadow_cache.tried > 0) {
+    const double percent = (double(st.shadow_cache.hit)
+                            / double(st.shadow_cache.tried)) * 100.0;
+    println("  Cache Hit Rate  ", percent, '%');
+  }
+  if (st.ao_cache.tried > 0) {
+    println("    AO Cache Try  ", st.ao_cache.tried);
+    println("    AO Cache Hit  ", st.ao_cache.hit);
+  }
   println("     Light Count  ", s.lights().size());
+  println("  Indexed Lights  ", s.lightIndex().boundedCount());
   println("    Shader Count  ", s.shader_count);
   println("    Object Count  ", s.object_count);
   println("     Bound Count  ", s.bound_count);
   println("     Group Count  ", s.group_count);
   println("       CSG Count  ", s.csg_count);
+  if (s.csg_count > 0) {
+    println("CSG Tests Culled  ", st.csg_culled);
+  }
+  if (s.hidden_count > 0) {
+    println("  Hidden Objects  ", s.hidden_count);
+  }
   println("   Objects Tried  ", object_tried);
   println("     Objects Hit  ", object_hit);
   println("    Bounds Tried  ", st.bound.tried);
@@ -0,0 +1,78 @@
+//
+// QuantizedBoundsTest.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "QuantizedBounds.hh"
+#include "Random.hh"
+#include <algorithm>
+#include <cassert>
+
+#ifdef NDEBUG
+#error "can't run test with NDEBUG"
+#endif
+
+
+bool contains(const BBox& outer, const BBox& b)
+{
+  for (unsigned int i = 0; i < 3; ++i) {
+    if (b.pmin[i] < outer.pmin[i] || b.pmax[i] > outer.pmax[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+BBox randomBox(PCG32& rnd, Flt offset, Flt size)
+{
+  BBox b{INIT_NONE};
+  for (unsigned int i = 0; i < 3; ++i) {
+    const Flt a = offset + (rnd.uniform() * size);
+    const Flt c = offset + (rnd.uniform() * size);
+    b.pmin[i] = std::min(a, c);
+    b.pmax[i] = std::max(a, c);
+  }
+  return b;
+}
+
+BBox randomChild(PCG32& rnd, const BBox& parent)
+{
+  // random box inside parent (sometimes sharing parent faces)
+  BBox b{INIT_NONE};
+  for (unsigned int i = 0; i < 3; ++i) {
+    const Flt lo = parent.pmin[i], ext = parent.pmax[i] - lo;
+    Flt a = lo + (rnd.uniform() * ext);
+    Flt c = lo + (rnd.uniform() * ext);
+    if (rnd.uniform() < .1) { a = parent.pmin[i]; }
+    if (rnd.uniform() < .1) { c = parent.pmax[i]; }
+    b.pmin[i] = std::min(a, c);
+    b.pmax[i] = std::max(a, c);
+  }
+  return b;
+}
+
+void test_quantize(PCG32& rnd, Flt offset, Flt size)
+{
+  // decoded child boxes always contain the original box
+  QuantizedBounds qb;
+  for (int n = 0; n < 1000; ++n) {
+    const BBox parent = randomBox(rnd, offset, size);
+    const uint32_t node = qb.addNode();
+    for (int slot = 0; slot < 2; ++slot) {
+      const BBox box = randomChild(rnd, parent);
+      const BBox decoded = qb.setChild(node, parent, slot, box, 0);
+      assert(contains(decoded, box));
+    }
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  PCG32 rnd{1};
+  test_quantize(rnd, 0.0, 1.0);
+  test_quantize(rnd, -1000.0, 2000.0);
+  test_quantize(rnd, 12345.0, .001);
+  test_quantize(rnd, -5.0, 1.0e6);
+  return 0;
+}
@@ -0,0 +1,55 @@
+//
+// SpaceCurveTest.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "SpaceCurve.hh"
+#include <vector>
+#include <cassert>
+
+#ifdef NDEBUG
+#error "can't run test with NDEBUG"
+#endif
+
+
+void test_morton(uint32_t n)
+{
+  // every grid point visited exactly once
+  std::vector<int> count(n * n, 0);
+  for (uint32_t i = 0; i < n * n; ++i) {
+    const uint32_t x = mortonX(i), y = mortonY(i);
+    assert(x < n && y < n);
+    ++count[(y * n) + x];
+  }
+  for (int c : count) { assert(c == 1); }
+}
+
+void test_hilbert(uint32_t n)
+{
+  // curve index is unique & consecutive indices are grid neighbors
+  std::vector<uint32_t> px(n * n, n), py(n * n, n);
+  for (uint32_t y = 0; y < n; ++y) {
+    for (uint32_t x = 0; x < n; ++x) {
+      const uint32_t d = hilbertIndex(n, x, y);
+      assert(d < n * n && px[d] == n);
+      px[d] = x; py[d] = y;
+    }
+  }
+
+  for (uint32_t d = 1; d < n * n; ++d) {
+    const uint32_t dx = (px[d] > px[d-1]) ? px[d] - px[d-1] : px[d-1] - px[d];
+    const uint32_t dy = (py[d] > py[d-1]) ? py[d] - py[d-1] : py[d-1] - py[d];
+    assert((dx + dy) == 1);
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  for (uint32_t n : {1, 2, 4, 16, 64}) {
+    test_morton(n);
+    test_hilbert(n);
+  }
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+//
+// SplitBoundTest.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "Parser.hh"
+#include "Scene.hh"
+#include "Object.hh"
+#include "Intersect.hh"
+#include "HitInfo.hh"
+#include "Stats.hh"
+#include "Ray.hh"
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cassert>
+
+#ifdef NDEBUG
+#error "can't run test with NDEBUG"
+#endif
+
+
+void findSplits(const Object& ob, std::map<const Object*,int>& refs,
+                std::vector<const Object*>& leaves)
+{
+  // count split references of each object
+  const auto children = ob.children();
+  if (ob.desc().starts_with("<Split")) {
+    assert(children.size() == 1);
+    ++refs[children[0].get()];
+    return;
+  }
+
+  if (children.empty()) { leaves.push_back(&ob); }
+  for (auto& c : children) { findSplits(*c, refs, leaves); }
+}
+
+void test_firstTest(std::span<const Object* const> objects)
+{
+  // every tested object is remembered, not just the last few
+  HitCache cache;
+  StatInfo stats;
+  HitList hl{cache, stats, false};
+  for (const Object* ob : objects) { assert(hl.firstTest(ob)); }
+  for (const Object* ob : objects) { assert(!hl.firstTest(ob)); }
+
+  {
+    // nested (csg) hit list has its own tested objects
+    HitList hl2{cache, stats, true};
+    assert(hl2.firstTest(objects[0]));
+    assert(!hl2.firstTest(objects[0]));
+  }
+  assert(!hl.firstTest(objects[0]));
+}
+
+void test_split(const char* file)
+{
+  SceneParser parser;
+  Scene s;
+  assert(parser.loadFile(file) >= 0);
+  assert(parser.setupScene(s) == 0);
+  assert(s.init() == 0);
+
+  std::map<const Object*,int> refs;
+  std::vector<const Object*> leaves;
+  for (auto& ob : s.optObjects()) { findSplits(*ob, refs, leaves); }
+  assert(refs.size() == 1);
+  const Object* bar = refs.begin()->first;
+  assert(refs.begin()->second > 8);
+
+  test_firstTest(leaves);
+
+  // ray along bar passes through all bounds bar was split into
+  // (each object must only add its hits once)
+  const Flt c = std::sqrt(.5);
+  Ray r;
+  r.base = {-30 * c, -30 * c, 0};
+  r.dir = {c, c, 0};
+
+  HitCache cache;
+  StatInfo stats;
+  for (bool csg : {false, true}) {
+    HitList hl{cache, stats, csg};
+    for (auto& ob : s.optObjects()) { ob->intersect(r, hl); }
+
+    int count = 0;
+    for (const HitInfo* h = hl.firstHit(); h != nullptr; h = h->next) {
+      assert(h->object == bar);
+      ++count;
+    }
+    assert(count == (csg ? 2 : 1));
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  // args: split scene
+  assert(argc == 2);
+  test_split(argv[1]);
+  return 0;
+}
@@ -0,0 +1,92 @@
+//
+// WavefrontTest.cc
+// Copyright (C) 2026 Richard Bradley
+//
+
+#include "Parser.hh"
+#include "Scene.hh"
+#include "Renderer.hh"
+#include "FrameBuffer.hh"
+#include "JobState.hh"
+#include <cmath>
+#include <cassert>
+
+#ifdef NDEBUG
+#error "can't run test with NDEBUG"
+#endif
+
+
+void render(const char* file, bool wavefront, FrameBuffer& fb)
+{
+  SceneParser parser;
+  Scene s;
+  assert(parser.loadFile(file) >= 0);
+  assert(parser.setupScene(s) == 0);
+  s.wavefront = wavefront;
+  assert(s.init() == 0);
+
+  Renderer ren;
+  assert(ren.init(&s, &fb) == 0);
+
+  JobState js;
+  js.init(s);
+  for (int y = s.region_min[1]; y <= s.region_max[1]; ++y) {
+    ren.render(js, s.region_min[0], y, s.region_max[0], y);
+  }
+  ren.finish();
+}
+
+void test_exact(const char* file)
+{
+  // queued rays & shadows must add up to the recursive result
+  FrameBuffer fb0, fb1;
+  render(file, false, fb0);
+  render(file, true, fb1);
+
+  assert(fb0.width() > 0 && fb0.width() == fb1.width());
+  assert(fb0.height() > 0 && fb0.height() == fb1.height());
+  for (int y = 0; y < fb0.height(); ++y) {
+    for (int x = 0; x < fb0.width(); ++x) {
+      const Color c0 = fb0.value(x, y), c1 = fb1.value(x, y);
+      for (int i = 0; i < 3; ++i) {
+        assert(std::abs(c0[i] - c1[i]) < .0005f);
+      }
+    }
+  }
+}
+
+void test_average(const char* file)
+{
+  // queued rays use their own random streams so sampled shaders like
+  // occlusion only match on average
+  FrameBuffer fb0, fb1;
+  render(file, false, fb0);
+  render(file, true, fb1);
+
+  assert(fb0.width() > 0 && fb0.width() == fb1.width());
+  assert(fb0.height() > 0 && fb0.height() == fb1.height());
+  double diff = 0, absDiff = 0;
+  for (int y = 0; y < fb0.height(); ++y) {
+    for (int x = 0; x < fb0.width(); ++x) {
+      const Color c0 = fb0.value(x, y), c1 = fb1.value(x, y);
+      for (int i = 0; i < 3; ++i) {
+        diff += double(c1[i] - c0[i]);
+        absDiff += std::abs(double(c1[i] - c0[i]));
+      }
+    }
+  }
+
+  const double n = double(fb0.width() * fb0.height() * 3);
+  assert(std::abs(diff / n) < .0005);
+  assert(absDiff / n < .002);
+}
+
+
+int main(int argc, char** argv)
+{
+  // args: exact match scene, sampled scene
+  assert(argc == 3);
+  test_exact(argv[1]);
+  test_average(argv[2]);
+  return 0;
+}
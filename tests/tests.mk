@@ -3,3 +3,17 @@ INCLUDE_TEST = src
 SOURCE_DIR_TEST = tests
 
 TEST_Vector3D.SRC = Vector3DTest.cc
+TEST_SpaceCurve.SRC = SpaceCurveTest.cc
+TEST_QuantizedBounds.SRC = QuantizedBoundsTest.cc\
+  ../src/QuantizedBounds.cc ../src/Ray.cc
+
+TEST_Wavefront.SRC = WavefrontTest.cc\
+  $(addprefix ../src/,$(base_src) $(object_src) $(shader_src) $(light_src)\
+  $(parser_src))
+TEST_Wavefront.ARGS =\
+  tests/WavefrontTest.sdl tests/WavefrontOcclusionTest.sdl
+
+TEST_SplitBound.SRC = SplitBoundTest.cc\
+  $(addprefix ../src/,$(base_src) $(object_src) $(shader_src) $(light_src)\
+  $(parser_src))
+TEST_SplitBound.ARGS = tests/SplitBoundTest.sdl